@@ -0,0 +1,21 @@
+#include "vipch.hpp"
+#include "Platform/Null/NullWindow.hpp"
+
+#include <thread>
+
+namespace Vi {
+	NullWindow::NullWindow(const WindowProperties& props) {
+		m_Data.Title = props.Title;
+		m_Data.Width = props.Width;
+		m_Data.Height = props.Height;
+
+		VI_CORE_INFO("Creating headless window {0} ({1}, {2})", props.Title, props.Width, props.Height);
+	}
+
+	void NullWindow::waitEvents(double timeout) {
+		// Nothing ever produces events here, so waiting is just sleeping
+		if (timeout > 0.0) {
+			std::this_thread::sleep_for(std::chrono::duration<double>(timeout));
+		}
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Vi/Core/Window.hpp"
+
+namespace Vi {
+    // Window without any display or graphics context, used by headless applications
+    class NullWindow: public Window {
+    public:
+        NullWindow(const WindowProperties& props);
+        ~NullWindow() override = default;
+
+        void onUpdate() override {}
+        void pollEvents() override {}
+        void swapBuffers() override {}
+        void waitEvents(double timeout) override;
+        void makeContextCurrent(bool current) override {}
+
+        uint32_t getWidth() const override {
+            return m_Data.Width;
+        }
+
+        uint32_t getHeight() const override {
+            return m_Data.Height;
+        }
+
+        void setEventCallback(const EventCallbackFn& callback) override {
+            m_Data.EventCallback = callback;
+        }
+
+        void setVSync(bool enabled) override {
+            m_Data.VSync = enabled;
+        }
+
+        bool isVSync() const override {
+            return m_Data.VSync;
+        }
+
+        void* getNativeWindow() const override {
+            return nullptr;
+        }
+
+    private:
+        struct WindowData {
+            std::string Title;
+            uint32_t Width{ 0 };
+            uint32_t Height{ 0 };
+            bool VSync{ false };
+
+            EventCallbackFn EventCallback;
+        };
+
+        WindowData m_Data;
+    };
+}
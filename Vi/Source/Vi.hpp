@@ -13,6 +13,7 @@
 #include "Vi/Core/Assert.hpp"
 
 #include "Vi/Core/Timestep.hpp"
+#include "Vi/Core/JobSystem.hpp"
 
 #include "Vi/Core/Input.hpp"
 #include "Vi/Core/KeyCodes.hpp"
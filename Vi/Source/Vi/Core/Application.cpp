@@ -1,31 +1,450 @@
 #include "vipch.hpp"
 #include "Vi/Core/Application.hpp"
 #include "Vi/Core/Input.hpp"
+#include "Vi/Core/JobSystem.hpp"
 #include "Vi/Core/Log.hpp"
+#include "Vi/Debug/FrameStatsPanel.hpp"
 #include "Vi/Scripting/ScriptEngine.hpp"
 #include "Vi/Renderer/Renderer.hpp"
 #include "Vi/Utils/PlatformUtils.hpp"
 
+#include <cmath>
+
 namespace Vi {
 	Application* Application::s_Instance{ nullptr };
 
 	Application::Application(const ApplicationSpecification& specification): m_Specification(specification) {
 		VI_PROFILE_FUNCTION();
+		VI_MEMORY_TAG(Core);
 
 		VI_CORE_ASSERT(!s_Instance, "Application already exists!");
 		s_Instance = this;
 
+		VI_CORE_ASSERT(m_Specification.FixedTimestep > 0.0f, "Fixed timestep has to be positive!");
+		VI_CORE_ASSERT(m_Specification.MaxFixedStepsPerFrame > 0, "At least one fixed step per frame is required!");
+
 		//Set working directory here
 		if (!m_Specification.WorkingDirectory.empty()) {
 			std::filesystem::current_path(m_Specification.WorkingDirectory);
 		}
 
-		m_Window = Window::create(WindowProperties(m_Specification.Name));
-		m_Window->setEventCallback(VI_BIND_EVENT_FN(Application::onEvent));
+		if (m_Specification.ProfileHardwareCounters) {
+			HardwareCounters::setEnabled(true);
+		}
+
+		JobSystem::init(m_Specification.WorkerThreadCount);
+
+		if (m_Specification.Headless) {
+			m_Window = Window::createHeadless(WindowProperties(m_Specification.Name));
+		}
+		else {
+			m_Window = Window::create(WindowProperties(m_Specification.Name));
+		}
+		if (!m_Specification.EventRecordPath.empty()) {
+			m_EventRecorder = createScope<EventRecorder>();
+			if (m_EventRecorder->open(m_Specification.EventRecordPath)) {
+				m_EventDispatcher.setRecorder(m_EventRecorder.get());
+			}
+		}
+
+		if (!m_Specification.EventReplayPath.empty()) {
+			m_EventReplayer = createScope<EventReplayer>();
+			if (!m_EventReplayer->open(m_Specification.EventReplayPath)) {
+				m_EventReplayer.reset();
+			}
+		}
+
+		// Window events are queued and delivered at the start of the next frame
+		m_Window->setEventCallback([this](Event& event) { onWindowEvent(event); });
+		m_EventDispatcher.addListener<&Application::onWindowClose>(this);
+		m_EventDispatcher.addListener<&Application::onWindowResize>(this);
+		m_EventDispatcher.addListener<&Application::onWindowFocus>(this);
+		m_EventDispatcher.addListener<&Application::onWindowLostFocus>(this);
+		m_EventDispatcher.addListener<&Application::onEvent>(this);
+		m_EventDispatcher.setProcessingBudget(m_Specification.EventProcessingBudget);
+
+		m_FrameStats.setEnabled(m_Specification.CollectFrameStats);
+		m_FrameStats.setWindowSize(m_Specification.FrameStatsWindow);
+
+		if (!m_Specification.Headless) {
+			Renderer::init();
+
+			auto imGuiLayer = createScope<ImGuiLayer>();
+			m_ImGuiLayer = imGuiLayer.get();
+			pushOverlay(std::move(imGuiLayer));
+
+			if (m_Specification.ShowFrameStats) {
+				pushOverlay(createScope<FrameStatsPanel>(m_FrameStats));
+			}
+		}
+	}
+
+	Application::~Application() {
+		VI_PROFILE_FUNCTION();
+
+		m_EventDispatcher.setRecorder(nullptr);
+
+		if (!m_Specification.FrameStatsExportPath.empty()) {
+			const std::filesystem::path path = m_Specification.FrameStatsExportPath;
+			if (path.extension() == ".json") {
+				m_FrameStats.exportJson(path);
+			}
+			else {
+				m_FrameStats.exportCsv(path);
+			}
+		}
+
+		JobSystem::shutdown();
+
+		// Headless runs never bring up scripting or the renderer
+		if (!m_Specification.Headless) {
+			ScriptEngine::shutdown();
+			Renderer::shutdown();
+		}
+	}
+
+	Layer* Application::pushLayer(Scope<Layer> layer) {
+		return m_LayerStack.pushLayer(std::move(layer));
+	}
+
+	Layer* Application::pushOverlay(Scope<Layer> layer) {
+		return m_LayerStack.pushOverlay(std::move(layer));
+	}
+
+	void Application::popLayer(Layer* layer) {
+		m_LayerStack.popLayer(layer);
+	}
+
+	void Application::popOverlay(Layer* layer) {
+		m_LayerStack.popOverlay(layer);
+	}
+
+	void Application::close() {
+		m_Running = false;
+	}
+
+	void Application::pushMainThreadTask(MainThreadTask&& task) {
+		if (!m_MainThreadOverflowPending.load(std::memory_order_acquire) && m_MainThreadQueue.tryPush(task)) {
+			return;
+		}
+
+		std::scoped_lock<std::mutex> lock(m_MainThreadOverflowMutex);
+		m_MainThreadOverflow.emplace_back(std::move(task));
+		m_MainThreadOverflowPending.store(true, std::memory_order_release);
+	}
+
+	void Application::onEvent(Event& e) {
+		VI_PROFILE_FUNCTION();
+
+		const auto& layers = m_LayerStack.getLayers(LayerPhase::Event);
+		for (auto it = layers.rbegin(); it != layers.rend(); ++it) {
+			FrameStats::LayerTimer timer(m_FrameStats, *it, LayerTiming::Event);
+			(*it)->onEvent(e);
+		}
+	}
+
+	void Application::run() {
+		VI_PROFILE_FUNCTION();
+
+		// Layers pushed during construction get attached while the graphics context is still on this thread
+		applyLayerChanges();
+
+		const bool pipelined = m_Specification.PipelinedRendering && !m_Specification.Headless;
+		if (pipelined) {
+			m_FramePipeline.start(*m_Window, [this](RenderPacket& packet) {
+				if (!m_Minimized) {
+					renderImGui();
+				}
+			}, [this](RenderPacket& packet) {
+				packet.execute();
+				m_Window->swapBuffers();
+			});
+		}
+
+		m_FramePacer.setTargetFrameRate(m_Specification.TargetFrameRate);
+		m_FrameTimer.reset();
+
+		while (m_Running) {
+			VI_PROFILE_SCOPE("RunLoop");
+
+			beginEventFrame();
+			const bool throttled = waitInBackground();
+			const Timestep timestep = static_cast<float>(m_FrameTimer.lap());
+			// Throttled frames are slow on purpose and would only trigger hitch dumps
+			if (!throttled) {
+				VI_PROFILE_FRAME(timestep.getSeconds());
+			}
+			m_FrameStats.beginFrame();
+
+			applyLayerChanges();
+
+			if (pipelined) {
+				m_Window->pollEvents();
+			}
+
+			m_EventDispatcher.process();
+			executeMainThreadQueue();
+
+			if (!m_Minimized) {
+				VI_MEMORY_TAG(Layer);
+
+				if (m_Specification.UseFixedTimestep) {
+					runFixedUpdates(timestep);
+				}
+				else {
+					m_InterpolationAlpha = 1.0f;
+				}
+
+				{
+					VI_PROFILE_SCOPE("LayerStack onUpdate");
+
+					for (const auto& batch : m_LayerStack.getUpdateBatches()) {
+						if (batch.size() == 1) {
+							FrameStats::LayerTimer timer(m_FrameStats, batch.front(), LayerTiming::Update);
+							batch.front()->onUpdate(timestep);
+							continue;
+						}
+
+						JobSystem::parallelFor(static_cast<uint32_t>(batch.size()), 1, [this, &batch, timestep](uint32_t index) {
+							VI_MEMORY_TAG(Layer);
+							FrameStats::LayerTimer timer(m_FrameStats, batch[index], LayerTiming::Update);
+							batch[index]->onUpdate(timestep);
+						});
+					}
+				}
+
+				if (!pipelined) {
+					{
+						VI_PROFILE_SCOPE("LayerStack onRender");
+
+						for (auto* layer : m_LayerStack.getLayers(LayerPhase::Render)) {
+							FrameStats::LayerTimer timer(m_FrameStats, layer, LayerTiming::Render);
+							layer->onRender(m_InterpolationAlpha);
+						}
+					}
+
+					renderImGui();
+				}
+			}
+
+			if (pipelined) {
+				buildRenderPacket();
+				m_FramePipeline.submit();
+			}
+			else {
+				m_Window->onUpdate();
+			}
+
+			// Frames stretched by background throttling would drown out the ones worth looking at
+			if (!throttled) {
+				m_FrameStats.endFrame(timestep.getSeconds());
+				m_FramePacer.wait();
+			}
+			else {
+				m_FrameStats.discardFrame();
+			}
+			LogLimiter::reportSuppressed();
+			MemoryTracker::endFrame();
+			m_FrameIndex++;
+		}
+
+		m_FramePipeline.stop();
+	}
 
-		Renderer::init();
+	void Application::applyLayerChanges() {
+		if (m_LayerStack.applyPendingChanges()) {
+			m_FrameStats.syncLayers(m_LayerStack.getAllLayers());
+		}
+	}
 
-		m_ImGuiLayer = new ImGuiLayer();
-		pushOverlay(m_ImGuiLayer);
+	void Application::renderImGui() {
+		if (!m_ImGuiLayer) {
+			return;
+		}
+
+		VI_MEMORY_TAG(Layer);
+
+		m_ImGuiLayer->begin();
+		{
+			VI_PROFILE_SCOPE("LayerStack onImGuiRender");
+
+			for (auto* layer : m_LayerStack.getLayers(LayerPhase::ImGuiRender)) {
+				FrameStats::LayerTimer timer(m_FrameStats, layer, LayerTiming::ImGuiRender);
+				layer->onImGuiRender();
+			}
+		}
+		m_ImGuiLayer->end();
+	}
+
+	void Application::buildRenderPacket() {
+		VI_PROFILE_FUNCTION();
+		VI_MEMORY_TAG(Renderer);
+
+		auto& packet = m_FramePipeline.getPacket();
+		packet.reset(m_FrameIndex, m_InterpolationAlpha);
+
+		// The graphics context lives on the render thread, so the viewport change has to travel with the packet
+		if (m_PendingViewportResize) {
+			packet.submit([width = m_Window->getWidth(), height = m_Window->getHeight()]() {
+				Renderer::onWindowResize(width, height);
+			});
+			m_PendingViewportResize = false;
+		}
+
+		if (m_Minimized) {
+			return;
+		}
+
+		for (auto* layer : m_LayerStack.getLayers(LayerPhase::BuildRenderPacket)) {
+			FrameStats::LayerTimer timer(m_FrameStats, layer, LayerTiming::Render);
+			layer->onBuildRenderPacket(packet);
+		}
+	}
+
+	void Application::onWindowEvent(Event& event) {
+		if (m_EventReplayer && event.getType() != EventType::WindowClose) {
+			return;
+		}
+
+		m_EventDispatcher.sendEvent(event);
+	}
+
+	void Application::beginEventFrame() {
+		VI_MEMORY_TAG(Event);
+
+		if (m_EventRecorder) {
+			m_EventRecorder->beginFrame(m_FrameIndex);
+		}
+
+		if (!m_EventReplayer) {
+			return;
+		}
+
+		m_EventReplayer->replayFrame(m_FrameIndex, m_EventDispatcher);
+		if (m_EventReplayer->isFinished()) {
+			VI_CORE_INFO("Event replay finished after {0} events at frame {1}", m_EventReplayer->getReplayedEventCount(), m_FrameIndex);
+			close();
+		}
+	}
+
+	bool Application::waitInBackground() {
+		if (!m_Specification.ThrottleInBackground || (!m_Minimized && m_Focused)) {
+			return false;
+		}
+
+		VI_PROFILE_FUNCTION();
+
+		// Events keep being dispatched while waiting, stop early once the window is back in the foreground
+		const double interval = 1.0 / std::max(m_Specification.BackgroundUpdateRate, 0.1f);
+		const Timer timer;
+		for (double remaining = interval; remaining > 0.0 && m_Running && (m_Minimized || !m_Focused); remaining = interval - timer.elapsedSeconds()) {
+			m_Window->waitEvents(remaining);
+			m_EventDispatcher.process();
+		}
+
+		return true;
+	}
+
+	void Application::runFixedUpdates(Timestep timestep) {
+		VI_PROFILE_FUNCTION();
+
+		const double fixedTimestep = m_Specification.FixedTimestep;
+		m_FixedTimeAccumulator += timestep.getSeconds();
+
+		uint32_t steps{ 0 };
+		while (m_FixedTimeAccumulator >= fixedTimestep && steps < m_Specification.MaxFixedStepsPerFrame) {
+			for (auto* layer : m_LayerStack.getLayers(LayerPhase::FixedUpdate)) {
+				FrameStats::LayerTimer timer(m_FrameStats, layer, LayerTiming::FixedUpdate);
+				layer->onFixedUpdate(m_Specification.FixedTimestep);
+			}
+
+			m_FixedTimeAccumulator -= fixedTimestep;
+			steps++;
+		}
+
+		// Simulation could not keep up, drop the backlog instead of spiralling into longer and longer frames.
+		// Only the start and end of a streak are logged, sustained load would flood the log otherwise.
+		if (m_FixedTimeAccumulator >= fixedTimestep) {
+			const auto dropped = static_cast<uint64_t>(m_FixedTimeAccumulator / fixedTimestep);
+			if (m_DroppedFixedStepStreak == 0) {
+				VI_CORE_WARN("Fixed update fell behind, dropping steps");
+			}
+			m_DroppedFixedStepStreak += dropped;
+			m_DroppedFixedSteps += dropped;
+			m_FixedTimeAccumulator = std::fmod(m_FixedTimeAccumulator, fixedTimestep);
+		}
+		else if (m_DroppedFixedStepStreak > 0) {
+			VI_CORE_WARN("Fixed update caught up after dropping {0} steps", m_DroppedFixedStepStreak);
+			m_DroppedFixedStepStreak = 0;
+		}
+
+		m_InterpolationAlpha = static_cast<float>(m_FixedTimeAccumulator / fixedTimestep);
+	}
+
+	bool Application::onWindowClose(WindowCloseEvent& event) {
+		m_Running = false;
+		return true;
+	}
+
+	bool Application::onWindowResize(WindowResizeEvent& event) {
+		VI_PROFILE_FUNCTION();
+
+		if (event.getWidth() == 0 || event.getHeight() == 0) {
+			m_Minimized = true;
+			return false;
+		}
+
+		m_Minimized = false;
+
+		if (m_FramePipeline.isRunning()) {
+			m_PendingViewportResize = true;
+		}
+		else {
+			Renderer::onWindowResize(event.getWidth(), event.getHeight());
+		}
+
+		return false;
+	}
+
+	bool Application::onWindowFocus(WindowFocusEvent& event) {
+		m_Focused = true;
+		return false;
+	}
+
+	bool Application::onWindowLostFocus(WindowLostFocusEvent& event) {
+		m_Focused = false;
+		return false;
+	}
+
+	void Application::executeMainThreadQueue() {
+		VI_PROFILE_FUNCTION();
+
+		const float budget = m_Specification.MainThreadQueueBudget;
+		Timer timer;
+		MainThreadTask task;
+
+		while (budget <= 0.0f || timer.elapsedMillis() < budget) {
+			// Overflow tasks taken in a previous frame are older than anything still in the ring
+			if (m_MainThreadBacklogIndex < m_MainThreadBacklog.size()) {
+				m_MainThreadBacklog[m_MainThreadBacklogIndex++]();
+				continue;
+			}
+
+			if (m_MainThreadQueue.tryPop(task)) {
+				task();
+				continue;
+			}
+
+			if (!m_MainThreadOverflowPending.load(std::memory_order_acquire)) {
+				break;
+			}
+
+			m_MainThreadBacklog.clear();
+			m_MainThreadBacklogIndex = 0;
+
+			std::scoped_lock<std::mutex> lock(m_MainThreadOverflowMutex);
+			std::swap(m_MainThreadBacklog, m_MainThreadOverflow);
+			m_MainThreadOverflowPending.store(false, std::memory_order_release);
+		}
 	}
 }
@@ -1,11 +1,20 @@
 #pragma once
 
 #include "Vi/Core/Base.hpp"
+#include "Vi/Core/FramePacer.hpp"
+#include "Vi/Core/FramePipeline.hpp"
+#include "Vi/Core/InplaceFunction.hpp"
 #include "Vi/Core/LayerStack.hpp"
+#include "Vi/Core/MPSCQueue.hpp"
+#include "Vi/Core/Timer.hpp"
 #include "Vi/Core/Timestep.hpp"
 #include "Vi/Core/Window.hpp"
+#include "Vi/Debug/FrameStats.hpp"
+#include "Vi/Debug/Instrumentor.hpp"
 #include "Vi/Event/Event.hpp"
 #include "Vi/Event/ApplicationEvent.hpp"
+#include "Vi/Event/EventDispatcher.hpp"
+#include "Vi/Event/EventRecorder.hpp"
 #include "Vi/ImGui/ImGuiLayer.hpp"
 
 int main(int argc, char** argv);
@@ -25,6 +34,54 @@ namespace Vi {
         std::string Name{ "Vi Application" };
         std::string WorkingDirectory;
         ApplicationCommandLineArgs CommandLineArgs;
+
+        // Runs without a display: no window, renderer or ImGui, only layers, events and simulation
+        bool Headless{ false };
+
+        // Fixed-rate simulation: layers get onFixedUpdate at FixedTimestep intervals and
+        // onRender receives the interpolation alpha between the last two simulation steps
+        bool UseFixedTimestep{ false };
+        float FixedTimestep{ 1.0f / 60.0f };
+        uint32_t MaxFixedStepsPerFrame{ 5 };
+
+        // Milliseconds per frame spent on tasks submitted to the main thread, 0 drains the whole queue
+        float MainThreadQueueBudget{ 0.0f };
+
+        // Microseconds per frame spent on events that are not critical, the rest is delivered next frame. 0 delivers everything.
+        uint32_t EventProcessingBudget{ 0 };
+
+        // Threads started for the JobSystem, 0 uses one per hardware thread besides the main thread
+        uint32_t WorkerThreadCount{ 0 };
+
+        // Overlaps the update of the next frame with render submission of the current one on a render thread
+        bool PipelinedRendering{ false };
+
+        // Caps the frame rate with a sleep-then-spin limiter, 0 leaves the loop unthrottled
+        float TargetFrameRate{ 0.0f };
+
+        // While minimized or unfocused the loop blocks on window events and runs at most BackgroundUpdateRate frames per second
+        bool ThrottleInBackground{ true };
+        float BackgroundUpdateRate{ 10.0f };
+
+        // Writes every window and input event with its frame index to a binary log
+        std::string EventRecordPath;
+        // Replays a recorded log as the only input source, live window events are ignored apart from closing the window.
+        // The application closes once the log is exhausted.
+        std::string EventReplayPath;
+
+        // Keeps the most recent profile scopes in memory instead of writing a runtime trace, dumped on hitches or on request
+        bool UseFlightRecorder{ false };
+        FlightRecorderSpecification FlightRecorder;
+        // Adds cycles, instructions, cache and branch misses to every profile scope, Linux only
+        bool ProfileHardwareCounters{ false };
+
+        // Rolling frame time and per-layer callback timings over the last FrameStatsWindow frames
+        bool CollectFrameStats{ true };
+        uint32_t FrameStatsWindow{ 300 };
+        // Pushes the frame stats ImGui panel as an overlay
+        bool ShowFrameStats{ false };
+        // Written when the application shuts down, .json exports JSON and anything else CSV
+        std::string FrameStatsExportPath;
     };
 
     class Application {
@@ -34,8 +91,11 @@ namespace Vi {
 
         void onEvent(Event& e);
 
-        void pushLayer(Layer* layer);
-        void pushOverlay(Layer* layer);
+        // Stack changes are applied at the start of the next frame
+        Layer* pushLayer(Scope<Layer> layer);
+        Layer* pushOverlay(Scope<Layer> layer);
+        void popLayer(Layer* layer);
+        void popOverlay(Layer* layer);
 
         Window& getWindow() {
             return *m_Window;
@@ -55,26 +115,92 @@ namespace Vi {
             return m_Specification;
         }
 
-        void submitToMainThread(const std::function<void()>& function);
+        EventDispatcher& getEventDispatcher() {
+            return m_EventDispatcher;
+        }
+
+        FramePacer& getFramePacer() {
+            return m_FramePacer;
+        }
+
+        FrameStats& getFrameStats() {
+            return m_FrameStats;
+        }
+
+        template<typename Function>
+        void submitToMainThread(Function&& function) {
+            using Target = std::decay_t<Function>;
+
+            if constexpr (MainThreadTask::canStore<Target>()) {
+                pushMainThreadTask(MainThreadTask(std::forward<Function>(function)));
+            }
+            else {
+                pushMainThreadTask(MainThreadTask([target = createScope<Target>(std::forward<Function>(function))]() {
+                    (*target)();
+                }));
+            }
+        }
+
+        [[nodiscard]] float getInterpolationAlpha() const {
+            return m_InterpolationAlpha;
+        }
+
+        // Fixed steps skipped because the simulation fell behind, since startup
+        [[nodiscard]] uint64_t getDroppedFixedStepCount() const {
+            return m_DroppedFixedSteps;
+        }
 
     private:
+        using MainThreadTask = InplaceFunction<void()>;
+        static constexpr std::size_t s_MainThreadQueueCapacity{ 4096 };
+
         void run();
 
         bool onWindowClose(WindowCloseEvent& event);
         bool onWindowResize(WindowResizeEvent& event);
+        bool onWindowFocus(WindowFocusEvent& event);
+        bool onWindowLostFocus(WindowLostFocusEvent& event);
+
+        bool waitInBackground();
+        void onWindowEvent(Event& event);
+        void beginEventFrame();
 
-        void executeMainThreadQueue(const std::function<void()>& function);
+        void pushMainThreadTask(MainThreadTask&& task);
+        void executeMainThreadQueue();
+        void runFixedUpdates(Timestep timestep);
+        void applyLayerChanges();
+        void renderImGui();
+        void buildRenderPacket();
 
         ApplicationSpecification m_Specification;
         Scope<Window> m_Window;
-        ImGuiLayer* m_ImGuiLayer;
+        ImGuiLayer* m_ImGuiLayer{ nullptr };
         bool m_Running{ true };
         bool m_Minimized{ false };
+        bool m_Focused{ true };
         LayerStack m_LayerStack;
-        float m_LastFrameTime{ 0.0f };
-
-        std::vector<std::function<void()>> m_MainThreadQueue;
-        std::mutex m_MainThreadQueueMutex;
+        EventDispatcher m_EventDispatcher;
+        Scope<EventRecorder> m_EventRecorder;
+        Scope<EventReplayer> m_EventReplayer;
+        Timer m_FrameTimer;
+        double m_FixedTimeAccumulator{ 0.0 };
+        uint64_t m_DroppedFixedSteps{ 0 };
+        uint64_t m_DroppedFixedStepStreak{ 0 };
+        float m_InterpolationAlpha{ 1.0f };
+        uint64_t m_FrameIndex{ 0 };
+
+        FramePipeline m_FramePipeline;
+        FramePacer m_FramePacer;
+        FrameStats m_FrameStats;
+        bool m_PendingViewportResize{ false };
+
+        MPSCQueue<MainThreadTask, s_MainThreadQueueCapacity> m_MainThreadQueue;
+        // Tasks that did not fit into the ring, producers keep using it until the main thread drains it to preserve ordering
+        std::vector<MainThreadTask> m_MainThreadOverflow;
+        std::atomic<bool> m_MainThreadOverflowPending{ false };
+        std::mutex m_MainThreadOverflowMutex;
+        std::vector<MainThreadTask> m_MainThreadBacklog;
+        std::size_t m_MainThreadBacklogIndex{ 0 };
 
         static Application* s_Instance;
         friend int ::main(int argc, char** argv);
@@ -0,0 +1,103 @@
+#include "vipch.hpp"
+#include "Vi/Core/BinaryLog.hpp"
+
+#include <spdlog/details/file_helper.h>
+#include <spdlog/sinks/base_sink.h>
+
+namespace Vi {
+	std::atomic<int> BinaryLog::s_Level{ spdlog::level::off };
+	Ref<spdlog::logger> BinaryLog::s_Logger;
+
+	namespace {
+		std::mutex s_SitesMutex;
+		uint32_t s_NextSiteId{ 1 };
+
+		// Prefixes each record with the time and thread spdlog captured on the logging thread
+		class BinaryFileSink final: public spdlog::sinks::base_sink<std::mutex> {
+		public:
+			explicit BinaryFileSink(const std::string& filepath) {
+				m_File.open(filepath, true);
+
+				BinaryLogFormat::FileHeader header{};
+				std::memcpy(header.Magic, BinaryLogFormat::s_Magic, sizeof(header.Magic));
+				header.Version = BinaryLogFormat::s_Version;
+
+				spdlog::memory_buf_t buffer;
+				buffer.append(reinterpret_cast<const char*>(&header), reinterpret_cast<const char*>(&header) + sizeof(header));
+				m_File.write(buffer);
+			}
+
+		protected:
+			void sink_it_(const spdlog::details::log_msg& message) override {
+				BinaryLogFormat::RecordHeader header{};
+				header.Timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(message.time.time_since_epoch()).count();
+				header.ThreadId = static_cast<uint32_t>(message.thread_id);
+				header.Size = static_cast<uint32_t>(message.payload.size());
+
+				m_Buffer.clear();
+				m_Buffer.append(reinterpret_cast<const char*>(&header), reinterpret_cast<const char*>(&header) + sizeof(header));
+				m_Buffer.append(message.payload.data(), message.payload.data() + message.payload.size());
+				m_File.write(m_Buffer);
+			}
+
+			void flush_() override {
+				m_File.flush();
+			}
+
+		private:
+			spdlog::details::file_helper m_File;
+			spdlog::memory_buf_t m_Buffer;
+		};
+	}
+
+	Ref<spdlog::sinks::sink> BinaryLog::createFileSink(const std::string& filepath) {
+		return std::make_shared<BinaryFileSink>(filepath);
+	}
+
+	void BinaryLog::init(Ref<spdlog::sinks::sink> sink, spdlog::level::level_enum flushLevel) {
+		s_Logger = std::make_shared<spdlog::logger>("BIN", std::move(sink));
+		s_Logger->set_level(spdlog::level::trace);
+		s_Logger->flush_on(flushLevel);
+		s_Level.store(spdlog::level::trace, std::memory_order_relaxed);
+	}
+
+	void BinaryLog::shutdown() {
+		s_Level.store(spdlog::level::off, std::memory_order_relaxed);
+		if (s_Logger) {
+			s_Logger->flush();
+		}
+	}
+
+	void BinaryLog::submit(spdlog::level::level_enum level, std::string_view record) {
+		s_Logger->log(level, spdlog::string_view_t(record.data(), record.size()));
+	}
+
+	bool BinaryLog::isFormatRecord(const spdlog::details::log_msg& message) {
+		return message.payload.size() > 0 && static_cast<uint8_t>(message.payload[0]) == static_cast<uint8_t>(BinaryLogFormat::RecordKind::Format);
+	}
+
+	uint32_t BinaryLog::registerSite(LogSite& site, const std::string& loggerName, spdlog::level::level_enum level, std::string_view format) {
+		std::scoped_lock<std::mutex> lock(s_SitesMutex);
+
+		// Another thread may have registered the site while this one waited
+		if (const uint32_t id = site.Id.load(std::memory_order_acquire); id != 0) {
+			return id;
+		}
+
+		const uint32_t id = s_NextSiteId++;
+
+		std::string record;
+		Internal::appendRaw(record, BinaryLogFormat::RecordKind::Format);
+		Internal::appendRaw(record, id);
+		Internal::appendRaw(record, static_cast<uint8_t>(level));
+		Internal::appendString(record, loggerName);
+		Internal::appendString(record, site.File);
+		Internal::appendRaw(record, site.Line);
+		Internal::appendString(record, format);
+
+		// Submitted before the id is published, so every message using it is queued after its format
+		submit(level, record);
+		site.Id.store(id, std::memory_order_release);
+		return id;
+	}
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Vi/Core/Base.hpp"
+#include "Vi/Core/BinaryLogFormat.hpp"
+#include "Vi/Core/LogSite.hpp"
+
+#pragma warning(push, 0)
+#include <spdlog/spdlog.h>
+#pragma warning(pop)
+
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace Vi {
+    namespace Internal {
+        template<typename T>
+        void appendRaw(std::string& buffer, const T& value) {
+            buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        inline void appendString(std::string& buffer, std::string_view value) {
+            appendRaw(buffer, static_cast<uint32_t>(value.size()));
+            buffer.append(value);
+        }
+
+        template<typename T>
+        void encodeArgument(std::string& buffer, const T& value) {
+            using Tag = BinaryLogFormat::ArgumentTag;
+            using Value = std::remove_cv_t<T>;
+
+            if constexpr (std::is_same_v<Value, bool>) {
+                appendRaw(buffer, Tag::Bool);
+                appendRaw(buffer, static_cast<uint8_t>(value));
+            }
+            else if constexpr (std::is_same_v<Value, char>) {
+                appendRaw(buffer, Tag::Char);
+                appendRaw(buffer, value);
+            }
+            else if constexpr (std::is_enum_v<Value>) {
+                encodeArgument(buffer, static_cast<std::underlying_type_t<Value>>(value));
+            }
+            else if constexpr (std::is_integral_v<Value> && std::is_signed_v<Value>) {
+                appendRaw(buffer, Tag::Int);
+                appendRaw(buffer, static_cast<int64_t>(value));
+            }
+            else if constexpr (std::is_integral_v<Value>) {
+                appendRaw(buffer, Tag::UInt);
+                appendRaw(buffer, static_cast<uint64_t>(value));
+            }
+            else if constexpr (std::is_floating_point_v<Value>) {
+                appendRaw(buffer, Tag::Double);
+                appendRaw(buffer, static_cast<double>(value));
+            }
+            else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+                appendRaw(buffer, Tag::String);
+                if constexpr (std::is_pointer_v<Value>) {
+                    // A string_view of a null C string is undefined
+                    if (!value) {
+                        appendString(buffer, "(null)");
+                        return;
+                    }
+                }
+                appendString(buffer, std::string_view(value));
+            }
+            else if constexpr (std::is_pointer_v<Value>) {
+                appendRaw(buffer, Tag::Pointer);
+                appendRaw(buffer, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+            }
+            else {
+                // Anything else, e.g. glm types, has no binary representation and is formatted on the calling thread
+                appendRaw(buffer, Tag::String);
+                appendString(buffer, fmt::format("{}", value));
+            }
+        }
+    }
+
+    // Writes log messages as a format id and raw argument values instead of formatted text, ViLogDecoder turns
+    // the file back into text. Enabled through LogSpecification::FileFormat, sites are written by the VI_ log macros.
+    class BinaryLog {
+    public:
+        [[nodiscard]] static bool shouldLog(spdlog::level::level_enum level) {
+            return level >= s_Level.load(std::memory_order_relaxed);
+        }
+
+        template<typename Format, typename... Args>
+        static void write(LogSite& site, const Ref<spdlog::logger>& logger, spdlog::level::level_enum level, const Format& format, const Args&... args) {
+            // Only literal format strings identify a site, anything else is logged through a "{}" format
+            if constexpr (std::is_array_v<Format>) {
+                writeMessage(site, logger, level, format, args...);
+            }
+            else {
+                writeMessage(site, logger, level, "{}", format, args...);
+            }
+        }
+
+        // For a format string that is fixed for its site, e.g. one checked at compile time
+        template<typename... Args>
+        static void writeMessage(LogSite& site, const Ref<spdlog::logger>& logger, spdlog::level::level_enum level, std::string_view format, const Args&... args) {
+            static_assert(sizeof...(Args) <= UINT8_MAX, "Too many log arguments!");
+
+            uint32_t id = site.Id.load(std::memory_order_acquire);
+            if (id == 0) {
+                id = registerSite(site, logger->name(), level, format);
+            }
+
+            thread_local std::string buffer;
+            buffer.clear();
+            Internal::appendRaw(buffer, BinaryLogFormat::RecordKind::Message);
+            Internal::appendRaw(buffer, id);
+            Internal::appendRaw(buffer, static_cast<uint8_t>(sizeof...(Args)));
+            (Internal::encodeArgument(buffer, args), ...);
+
+            submit(level, buffer);
+        }
+
+    private:
+        friend class Log;
+
+        // Sink writing records into a binary file, Log may put it behind its asynchronous ring
+        static Ref<spdlog::sinks::sink> createFileSink(const std::string& filepath);
+        static void init(Ref<spdlog::sinks::sink> sink, spdlog::level::level_enum flushLevel);
+        static void shutdown();
+        static void submit(spdlog::level::level_enum level, std::string_view record);
+        // Format records must never be dropped, the decoder cannot print any message of a site without its format
+        static bool isFormatRecord(const spdlog::details::log_msg& message);
+        static uint32_t registerSite(LogSite& site, const std::string& loggerName, spdlog::level::level_enum level, std::string_view format);
+
+        static std::atomic<int> s_Level;
+        static Ref<spdlog::logger> s_Logger;
+    };
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+// Layout of binary log files, shared by the engine and the ViLogDecoder tool. Values are stored in native byte order.
+namespace Vi::BinaryLogFormat {
+    constexpr char s_Magic[4]{ 'V', 'I', 'L', 'G' };
+    constexpr uint32_t s_Version{ 1 };
+
+    struct FileHeader {
+        char Magic[4];
+        uint32_t Version;
+    };
+
+    // Precedes every record, Size bytes of payload follow and the first of them is the RecordKind
+    struct RecordHeader {
+        int64_t Timestamp;  // Nanoseconds since the system clock epoch
+        uint32_t ThreadId;
+        uint32_t Size;
+    };
+
+    enum class RecordKind : uint8_t {
+        // u32 id, u8 level, then logger name, file and format as strings, with the u32 line between file and format
+        Format = 1,
+        // u32 format id, u8 argument count, then one tag and value per argument
+        Message = 2
+    };
+
+    // Strings are a u32 length followed by the bytes, every other value is stored in its listed type
+    enum class ArgumentTag : uint8_t {
+        Int = 1,     // int64_t
+        UInt,        // uint64_t
+        Double,      // double
+        Bool,        // uint8_t
+        Char,        // char
+        String,
+        Pointer      // uint64_t
+    };
+}
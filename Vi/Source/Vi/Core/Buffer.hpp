@@ -19,7 +19,7 @@ namespace Vi {
 
         static Buffer copy(Buffer other) {
             Buffer result(other.Size);
-            memcpy_s(result.Data, result.Size, other.Data, other.Size);
+            std::memcpy(result.Data, other.Data, other.Size);
             return result;
         }
 
@@ -42,7 +42,7 @@ namespace Vi {
         }
 
         operator bool() const {
-            return reinterpret_cast<bool>(Data);
+            return Data != nullptr;
         }
     };
 
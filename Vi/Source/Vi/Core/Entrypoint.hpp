@@ -2,25 +2,42 @@
 #include "Vi/Core/Base.hpp"
 #include "Vi/Core/Application.hpp"
 
-#ifdef VI_PLATFORM_WINDOWS
+#if defined(VI_PLATFORM_WINDOWS) || defined(VI_PLATFORM_LINUX)
 
 extern Vi::Application* Vi::createApplication(ApplicationCommandLineArgs args);
 
 int main(int argc, char** argv)
 {
     Vi::Log::init();
+    VI_PROFILE_THREAD("Main");
+    Vi::MemoryTracker::captureBaseline();
 
     VI_PROFILE_BEGIN_SESSION("Startup", "ViProfile-Startup.json");
     auto app = Vi::createApplication({ argc, argv });
     VI_PROFILE_END_SESSION();
 
-    VI_PROFILE_BEGIN_SESSION("Runtime", "ViProfile-Runtime.json");
+    const bool flightRecorder = app->getSpecification().UseFlightRecorder;
+    if (flightRecorder) {
+        VI_PROFILE_BEGIN_FLIGHT_RECORDER(app->getSpecification().FlightRecorder);
+    }
+    else {
+        VI_PROFILE_BEGIN_SESSION("Runtime", "ViProfile-Runtime.json");
+    }
     app->run();
-    VI_PROFILE_END_SESSION();
+    if (flightRecorder) {
+        VI_PROFILE_END_FLIGHT_RECORDER();
+    }
+    else {
+        VI_PROFILE_END_SESSION();
+    }
 
     VI_PROFILE_BEGIN_SESSION("Shutdown", "ViProfile-Shutdown.json");
     delete app;
     VI_PROFILE_END_SESSION();
+
+    Vi::MemoryTracker::reportLeaks();
+
+    Vi::Log::shutdown();
 }
 
 #endif
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace Vi {
+    // Bump allocator for objects that live until the end of a frame. reset() keeps the blocks,
+    // so once the arena has grown to the frame's peak usage it stops allocating.
+    class FrameArena {
+    public:
+        explicit FrameArena(size_t blockSize = 64 * 1024): m_BlockSize(blockSize) {
+        }
+
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        void* allocate(size_t size, size_t alignment) {
+            for (;;) {
+                if (m_CurrentBlock < m_Blocks.size()) {
+                    auto& block = m_Blocks[m_CurrentBlock];
+                    const auto base = reinterpret_cast<uintptr_t>(block.Data.get());
+                    const uintptr_t aligned = (base + m_Offset + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+                    const size_t offset = aligned - base;
+
+                    if (offset + size <= block.Size) {
+                        m_Offset = offset + size;
+                        return block.Data.get() + offset;
+                    }
+
+                    m_CurrentBlock++;
+                    m_Offset = 0;
+                    continue;
+                }
+
+                const size_t blockSize = size + alignment > m_BlockSize ? size + alignment : m_BlockSize;
+                m_Blocks.push_back({ std::make_unique<std::byte[]>(blockSize), blockSize });
+            }
+        }
+
+        template<typename T, typename... Args>
+        T* create(Args&&... args) {
+            return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
+
+        // Does not run destructors, the owner of the objects is responsible for that
+        void reset() {
+            m_CurrentBlock = 0;
+            m_Offset = 0;
+        }
+
+    private:
+        struct Block {
+            std::unique_ptr<std::byte[]> Data;
+            size_t Size;
+        };
+
+        std::vector<Block> m_Blocks;
+        size_t m_BlockSize;
+        size_t m_CurrentBlock{ 0 };
+        size_t m_Offset{ 0 };
+    };
+}
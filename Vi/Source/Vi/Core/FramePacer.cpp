@@ -0,0 +1,134 @@
+#include "vipch.hpp"
+#include "Vi/Core/FramePacer.hpp"
+
+#include <cmath>
+#include <thread>
+
+#ifdef VI_PLATFORM_WINDOWS
+#include <timeapi.h>
+#endif
+
+namespace Vi {
+	namespace {
+		constexpr double s_InitialOvershoot{ 0.001 };
+		constexpr double s_MinSpinThreshold{ 0.0002 };
+		constexpr double s_MaxSpinThreshold{ 0.004 };
+		constexpr double s_OvershootSmoothing{ 0.1 };
+	}
+
+	FramePacer::FramePacer(): m_OvershootMean(s_InitialOvershoot) {}
+
+	FramePacer::~FramePacer() {
+		setFineTimerResolution(false);
+	}
+
+	void FramePacer::setTargetFrameRate(float framesPerSecond) {
+		m_TargetFrameRate = framesPerSecond > 0.0f ? framesPerSecond : 0.0f;
+		m_FrameDuration = m_TargetFrameRate > 0.0f ? 1.0 / m_TargetFrameRate : 0.0;
+		m_NextDeadline = m_Timer.elapsedSeconds();
+		m_LastFrameEnd = m_NextDeadline;
+
+		setFineTimerResolution(m_FrameDuration > 0.0);
+	}
+
+	void FramePacer::setFineTimerResolution(bool enabled) {
+		if (m_FineTimerResolution == enabled) {
+			return;
+		}
+		m_FineTimerResolution = enabled;
+
+#ifdef VI_PLATFORM_WINDOWS
+		// Default scheduler granularity is ~15ms which makes sleeping useless for pacing, raising it costs power system wide
+		if (enabled) {
+			timeBeginPeriod(1);
+		}
+		else {
+			timeEndPeriod(1);
+		}
+#endif
+	}
+
+	void FramePacer::wait() {
+		if (m_FrameDuration <= 0.0) {
+			return;
+		}
+
+		VI_PROFILE_FUNCTION();
+
+		m_NextDeadline += m_FrameDuration;
+
+		double now = m_Timer.elapsedSeconds();
+		if (now >= m_NextDeadline) {
+			// Too late already, restart the schedule from here instead of rushing the next frames to catch up
+			m_MissedDeadlines++;
+			m_NextDeadline = now;
+			recordFrame(now);
+			return;
+		}
+
+		sleepUntil(m_NextDeadline);
+
+		while (now < m_NextDeadline) {
+			std::this_thread::yield();
+			now = m_Timer.elapsedSeconds();
+		}
+
+		recordFrame(now);
+	}
+
+	double FramePacer::getSpinThreshold() const {
+		// Sleeping overshoots by a noisy amount, stay two deviations away from the deadline
+		return std::clamp(m_OvershootMean + 2.0 * std::sqrt(m_OvershootVariance), s_MinSpinThreshold, s_MaxSpinThreshold);
+	}
+
+	void FramePacer::sleepUntil(double deadline) {
+		for (;;) {
+			const double before = m_Timer.elapsedSeconds();
+			const double sleepTime = deadline - before - getSpinThreshold();
+			if (sleepTime <= 0.0) {
+				return;
+			}
+
+			std::this_thread::sleep_for(std::chrono::duration<double>(sleepTime));
+
+			const double overshoot = m_Timer.elapsedSeconds() - before - sleepTime;
+			const double difference = overshoot - m_OvershootMean;
+			m_OvershootMean += s_OvershootSmoothing * difference;
+			m_OvershootVariance = (1.0 - s_OvershootSmoothing) * (m_OvershootVariance + s_OvershootSmoothing * difference * difference);
+		}
+	}
+
+	void FramePacer::recordFrame(double now) {
+		const double jitter = std::abs((now - m_LastFrameEnd) - m_FrameDuration) * 1000.0;
+		m_LastFrameEnd = now;
+
+		m_FrameCount++;
+		m_JitterSum += jitter;
+		m_JitterSquaredSum += jitter * jitter;
+		m_MaxJitter = std::max(m_MaxJitter, jitter);
+	}
+
+	FramePacerStatistics FramePacer::getStatistics() const {
+		FramePacerStatistics statistics;
+		statistics.FrameCount = m_FrameCount;
+		statistics.MissedDeadlines = m_MissedDeadlines;
+		statistics.MaxJitter = m_MaxJitter;
+		statistics.SpinThreshold = getSpinThreshold() * 1000.0;
+
+		if (m_FrameCount > 0) {
+			const double count = static_cast<double>(m_FrameCount);
+			statistics.MeanJitter = m_JitterSum / count;
+			statistics.JitterStdDeviation = std::sqrt(std::max(0.0, m_JitterSquaredSum / count - statistics.MeanJitter * statistics.MeanJitter));
+		}
+
+		return statistics;
+	}
+
+	void FramePacer::resetStatistics() {
+		m_FrameCount = 0;
+		m_MissedDeadlines = 0;
+		m_JitterSum = 0.0;
+		m_JitterSquaredSum = 0.0;
+		m_MaxJitter = 0.0;
+	}
+}
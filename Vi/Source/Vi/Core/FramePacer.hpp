@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Vi/Core/Timer.hpp"
+
+#include <cstdint>
+
+namespace Vi {
+    // All durations are in milliseconds
+    struct FramePacerStatistics {
+        uint64_t FrameCount{ 0 };
+        uint64_t MissedDeadlines{ 0 };
+        // Difference between the actual and the target frame interval
+        double MeanJitter{ 0.0 };
+        double MaxJitter{ 0.0 };
+        double JitterStdDeviation{ 0.0 };
+        // How long before a deadline the pacer stops sleeping and starts spinning
+        double SpinThreshold{ 0.0 };
+    };
+
+    // Limits the frame rate by sleeping for most of the remaining frame time and spinning for the last part,
+    // the spin window adapts to how precise sleeping turns out to be on this machine.
+    class FramePacer {
+    public:
+        FramePacer();
+        ~FramePacer();
+
+        FramePacer(const FramePacer&) = delete;
+        FramePacer& operator=(const FramePacer&) = delete;
+
+        // 0 disables pacing
+        void setTargetFrameRate(float framesPerSecond);
+
+        [[nodiscard]] float getTargetFrameRate() const {
+            return m_TargetFrameRate;
+        }
+
+        // Blocks until the next frame deadline, call once at the end of every frame
+        void wait();
+
+        [[nodiscard]] FramePacerStatistics getStatistics() const;
+        void resetStatistics();
+
+    private:
+        // Only held while pacing is active
+        void setFineTimerResolution(bool enabled);
+        double getSpinThreshold() const;
+        void sleepUntil(double deadline);
+        void recordFrame(double now);
+
+        Timer m_Timer;
+        float m_TargetFrameRate{ 0.0f };
+        double m_FrameDuration{ 0.0 };
+        double m_NextDeadline{ 0.0 };
+        double m_LastFrameEnd{ 0.0 };
+        bool m_FineTimerResolution{ false };
+
+        double m_OvershootMean;
+        double m_OvershootVariance{ 0.0 };
+
+        uint64_t m_FrameCount{ 0 };
+        uint64_t m_MissedDeadlines{ 0 };
+        double m_JitterSum{ 0.0 };
+        double m_JitterSquaredSum{ 0.0 };
+        double m_MaxJitter{ 0.0 };
+    };
+}
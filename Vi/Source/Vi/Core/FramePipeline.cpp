@@ -0,0 +1,94 @@
+#include "vipch.hpp"
+#include "Vi/Core/FramePipeline.hpp"
+
+namespace Vi {
+	FramePipeline::~FramePipeline() {
+		stop();
+	}
+
+	void FramePipeline::start(Window& window, StageFn exclusiveStage, StageFn renderStage) {
+		VI_PROFILE_FUNCTION();
+
+		VI_CORE_ASSERT(!isRunning(), "FramePipeline already running!");
+
+		m_Window = &window;
+		m_ExclusiveStage = std::move(exclusiveStage);
+		m_RenderStage = std::move(renderStage);
+		m_Running = true;
+
+		// The render thread owns the graphics context while the pipeline runs
+		m_Window->makeContextCurrent(false);
+		m_Thread = std::thread(&FramePipeline::renderLoop, this);
+	}
+
+	void FramePipeline::stop() {
+		VI_PROFILE_FUNCTION();
+
+		if (!isRunning()) {
+			return;
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this] { return m_Idle && !m_Pending; });
+			m_Running = false;
+		}
+		m_Condition.notify_all();
+
+		m_Thread.join();
+		m_Window->makeContextCurrent(true);
+	}
+
+	void FramePipeline::submit() {
+		VI_PROFILE_FUNCTION();
+
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_Condition.wait(lock, [this] { return m_Idle; });
+
+		m_ReadIndex = m_WriteIndex;
+		m_WriteIndex ^= 1;
+		m_Pending = true;
+		m_Idle = false;
+		m_ExclusiveDone = false;
+		m_Condition.notify_all();
+
+		m_Condition.wait(lock, [this] { return m_ExclusiveDone; });
+	}
+
+	void FramePipeline::renderLoop() {
+		VI_PROFILE_THREAD("Render");
+		VI_MEMORY_TAG(Renderer);
+		m_Window->makeContextCurrent(true);
+
+		for (;;) {
+			uint32_t readIndex{ 0 };
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_Condition.wait(lock, [this] { return m_Pending || !m_Running; });
+				if (!m_Pending) {
+					break;
+				}
+
+				m_Pending = false;
+				readIndex = m_ReadIndex;
+			}
+
+			auto& packet = m_Packets[readIndex];
+			m_ExclusiveStage(packet);
+			{
+				std::scoped_lock<std::mutex> lock(m_Mutex);
+				m_ExclusiveDone = true;
+			}
+			m_Condition.notify_all();
+
+			m_RenderStage(packet);
+			{
+				std::scoped_lock<std::mutex> lock(m_Mutex);
+				m_Idle = true;
+			}
+			m_Condition.notify_all();
+		}
+
+		m_Window->makeContextCurrent(false);
+	}
+}
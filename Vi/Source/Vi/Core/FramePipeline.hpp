@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Vi/Core/Base.hpp"
+#include "Vi/Core/Window.hpp"
+#include "Vi/Renderer/RenderPacket.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace Vi {
+    // Two stage frame pipeline: the main thread builds the packet for frame N+1 while the render thread executes frame N.
+    // The exclusive stage runs on the render thread while the main thread waits, for work that still touches layer state (ImGui).
+    class FramePipeline {
+    public:
+        using StageFn = std::function<void(RenderPacket&)>;
+
+        FramePipeline() = default;
+        ~FramePipeline();
+
+        FramePipeline(const FramePipeline&) = delete;
+        FramePipeline& operator=(const FramePipeline&) = delete;
+
+        void start(Window& window, StageFn exclusiveStage, StageFn renderStage);
+        void stop();
+
+        // Packet the main thread is allowed to fill, never the one the render thread is consuming
+        RenderPacket& getPacket() {
+            return m_Packets[m_WriteIndex];
+        }
+
+        // Waits for the previous frame to finish rendering, hands the packet over and returns after the exclusive stage
+        void submit();
+
+        [[nodiscard]] bool isRunning() const {
+            return m_Thread.joinable();
+        }
+
+    private:
+        void renderLoop();
+
+        Window* m_Window{ nullptr };
+        StageFn m_ExclusiveStage;
+        StageFn m_RenderStage;
+
+        RenderPacket m_Packets[2];
+        uint32_t m_WriteIndex{ 0 };
+        uint32_t m_ReadIndex{ 0 };
+
+        std::thread m_Thread;
+        std::mutex m_Mutex;
+        std::condition_variable m_Condition;
+        bool m_Running{ false };
+        bool m_Pending{ false };
+        bool m_ExclusiveDone{ true };
+        bool m_Idle{ true };
+    };
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Vi {
+    template<typename Signature, std::size_t Capacity = 48>
+    class InplaceFunction;
+
+    // Move-only callable wrapper storing the target inside the object, never on the heap
+    template<typename R, typename... Args, std::size_t Capacity>
+    class InplaceFunction<R(Args...), Capacity> {
+    public:
+        InplaceFunction() = default;
+
+        template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InplaceFunction>>>
+        InplaceFunction(F&& function) {
+            using Target = std::decay_t<F>;
+            static_assert(canStore<Target>(), "Callable does not fit into InplaceFunction storage!");
+
+            new (&m_Storage) Target(std::forward<F>(function));
+            m_Invoke = [](void* target, Args&&... args) -> R {
+                return (*static_cast<Target*>(target))(std::forward<Args>(args)...);
+            };
+            m_Manage = [](void* destination, void* source) {
+                if (destination) {
+                    new (destination) Target(std::move(*static_cast<Target*>(source)));
+                }
+                static_cast<Target*>(source)->~Target();
+            };
+        }
+
+        InplaceFunction(InplaceFunction&& other) noexcept {
+            moveFrom(other);
+        }
+
+        InplaceFunction& operator=(InplaceFunction&& other) noexcept {
+            if (this != &other) {
+                reset();
+                moveFrom(other);
+            }
+            return *this;
+        }
+
+        InplaceFunction(const InplaceFunction&) = delete;
+        InplaceFunction& operator=(const InplaceFunction&) = delete;
+
+        ~InplaceFunction() {
+            reset();
+        }
+
+        R operator()(Args... args) {
+            return m_Invoke(&m_Storage, std::forward<Args>(args)...);
+        }
+
+        explicit operator bool() const {
+            return m_Invoke != nullptr;
+        }
+
+        void reset() {
+            if (m_Manage) {
+                m_Manage(nullptr, &m_Storage);
+            }
+            m_Invoke = nullptr;
+            m_Manage = nullptr;
+        }
+
+        template<typename F>
+        static constexpr bool canStore() {
+            return sizeof(F) <= Capacity && alignof(F) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<F>;
+        }
+
+    private:
+        void moveFrom(InplaceFunction& other) {
+            if (other.m_Manage) {
+                other.m_Manage(&m_Storage, &other.m_Storage);
+            }
+            m_Invoke = other.m_Invoke;
+            m_Manage = other.m_Manage;
+            other.m_Invoke = nullptr;
+            other.m_Manage = nullptr;
+        }
+
+        alignas(std::max_align_t) std::byte m_Storage[Capacity];
+        R(*m_Invoke)(void*, Args&&...){ nullptr };
+        void(*m_Manage)(void*, void*){ nullptr };
+    };
+}
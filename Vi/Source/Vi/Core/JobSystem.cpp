@@ -0,0 +1,292 @@
+#include "vipch.hpp"
+#include "Vi/Core/JobSystem.hpp"
+
+#include <deque>
+#include <thread>
+
+namespace Vi {
+	namespace {
+		constexpr uint32_t s_JobPoolSize{ 4096 };
+		constexpr int64_t s_DequeCapacity{ 4096 };
+		constexpr uint32_t s_NoThreadIndex{ UINT32_MAX };
+
+		struct Job {
+			JobSystem::JobFunction Function;
+			JobCounter* Counter{ nullptr };
+			// Set by the thread handing the slot out, cleared by whichever thread executed the job once it is done with it
+			std::atomic<bool> Busy{ false };
+		};
+
+		// Chase-Lev deque, the owner pushes and pops at the bottom while thieves take from the top
+		class WorkStealingDeque {
+		public:
+			bool push(Job* job) {
+				const int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+				const int64_t top = m_Top.load(std::memory_order_acquire);
+				if (bottom - top >= s_DequeCapacity) {
+					return false;
+				}
+
+				m_Jobs[bottom & (s_DequeCapacity - 1)].store(job, std::memory_order_relaxed);
+				m_Bottom.store(bottom + 1, std::memory_order_release);
+				return true;
+			}
+
+			Job* pop() {
+				const int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+				m_Bottom.store(bottom, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				int64_t top = m_Top.load(std::memory_order_relaxed);
+
+				if (top > bottom) {
+					m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+					return nullptr;
+				}
+
+				Job* job = m_Jobs[bottom & (s_DequeCapacity - 1)].load(std::memory_order_relaxed);
+				if (top == bottom) {
+					// Last job, race against thieves for it
+					if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+						job = nullptr;
+					}
+					m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+				}
+				return job;
+			}
+
+			Job* steal() {
+				int64_t top = m_Top.load(std::memory_order_acquire);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				const int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+
+				if (top >= bottom) {
+					return nullptr;
+				}
+
+				Job* job = m_Jobs[top & (s_DequeCapacity - 1)].load(std::memory_order_relaxed);
+				if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+					return nullptr;
+				}
+				return job;
+			}
+
+		private:
+			alignas(64) std::atomic<int64_t> m_Top{ 0 };
+			alignas(64) std::atomic<int64_t> m_Bottom{ 0 };
+			std::atomic<Job*> m_Jobs[s_DequeCapacity];
+		};
+
+		struct ThreadData {
+			WorkStealingDeque Deque;
+			// Only the owning thread hands out slots, starting after the last one it used
+			std::unique_ptr<Job[]> JobPool{ std::make_unique<Job[]>(s_JobPoolSize) };
+			uint32_t NextJob{ 0 };
+			uint32_t StealSeed{ 0 };
+		};
+
+		std::vector<Scope<ThreadData>> s_Threads;
+		std::vector<std::thread> s_Workers;
+		std::atomic<bool> s_Running{ false };
+		std::atomic<uint32_t> s_WorkEpoch{ 0 };
+		std::atomic<uint32_t> s_SleepingWorkers{ 0 };
+
+		// Jobs submitted from threads that are not owned by the job system
+		std::mutex s_ExternalMutex;
+		std::deque<Job*> s_ExternalJobs;
+		Job s_ExternalJobPool[s_JobPoolSize];
+		uint32_t s_NextExternalJob{ 0 };
+
+		thread_local uint32_t s_ThreadIndex{ s_NoThreadIndex };
+
+		// Returns nullptr when every slot is still in flight, the caller runs the job inline then
+		Job* acquireJob(Job* pool, uint32_t& next) {
+			for (uint32_t i = 0; i < s_JobPoolSize; i++) {
+				Job* job = &pool[next++ % s_JobPoolSize];
+				if (!job->Busy.load(std::memory_order_acquire)) {
+					job->Busy.store(true, std::memory_order_relaxed);
+					return job;
+				}
+			}
+			return nullptr;
+		}
+
+		void execute(Job* job) {
+			job->Function();
+			job->Function.reset();
+
+			// The slot may be reused as soon as it is released, nothing may touch the job afterwards
+			JobCounter* counter = job->Counter;
+			job->Busy.store(false, std::memory_order_release);
+
+			if (counter) {
+				counter->Pending.fetch_sub(1, std::memory_order_acq_rel);
+			}
+		}
+
+		Job* findJob() {
+			auto& self = *s_Threads[s_ThreadIndex];
+			if (Job* job = self.Deque.pop()) {
+				return job;
+			}
+
+			const auto threadCount = static_cast<uint32_t>(s_Threads.size());
+			const uint32_t start = self.StealSeed++ % threadCount;
+			for (uint32_t i = 0; i < threadCount; i++) {
+				const uint32_t victim = (start + i) % threadCount;
+				if (victim == s_ThreadIndex) {
+					continue;
+				}
+
+				if (Job* job = s_Threads[victim]->Deque.steal()) {
+					return job;
+				}
+			}
+
+			std::scoped_lock<std::mutex> lock(s_ExternalMutex);
+			if (!s_ExternalJobs.empty()) {
+				Job* job = s_ExternalJobs.front();
+				s_ExternalJobs.pop_front();
+				return job;
+			}
+
+			return nullptr;
+		}
+
+		void workerLoop(uint32_t threadIndex) {
+			s_ThreadIndex = threadIndex;
+			VI_PROFILE_THREAD("Job Worker " + std::to_string(threadIndex));
+			VI_MEMORY_TAG(Jobs);
+
+			while (s_Running.load(std::memory_order_acquire)) {
+				const uint32_t epoch = s_WorkEpoch.load(std::memory_order_acquire);
+
+				if (Job* job = findJob()) {
+					execute(job);
+					continue;
+				}
+
+				// Any job pushed after reading the epoch changes it, so the wait returns immediately instead of missing the wakeup
+				s_SleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+				s_WorkEpoch.wait(epoch, std::memory_order_acquire);
+				s_SleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+			}
+		}
+
+		void wakeWorkers() {
+			s_WorkEpoch.fetch_add(1, std::memory_order_seq_cst);
+			if (s_SleepingWorkers.load(std::memory_order_seq_cst) > 0) {
+				s_WorkEpoch.notify_one();
+			}
+		}
+	}
+
+	void JobSystem::init(uint32_t workerCount) {
+		VI_PROFILE_FUNCTION();
+
+		VI_CORE_ASSERT(!s_Running, "JobSystem already initialized!");
+
+		if (workerCount == 0) {
+			const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+			workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+		}
+
+		// Index 0 belongs to the thread calling init, which is expected to be the main thread
+		s_Threads.clear();
+		for (uint32_t i = 0; i <= workerCount; i++) {
+			s_Threads.emplace_back(createScope<ThreadData>());
+			s_Threads.back()->StealSeed = i;
+		}
+		s_ThreadIndex = 0;
+
+		s_Running.store(true, std::memory_order_release);
+		for (uint32_t i = 1; i <= workerCount; i++) {
+			s_Workers.emplace_back(workerLoop, i);
+		}
+
+		VI_CORE_INFO("JobSystem started with {0} worker threads", workerCount);
+	}
+
+	void JobSystem::shutdown() {
+		VI_PROFILE_FUNCTION();
+
+		if (!s_Running.exchange(false, std::memory_order_acq_rel)) {
+			return;
+		}
+
+		s_WorkEpoch.fetch_add(1, std::memory_order_seq_cst);
+		s_WorkEpoch.notify_all();
+
+		for (auto& worker : s_Workers) {
+			worker.join();
+		}
+
+		s_Workers.clear();
+		s_Threads.clear();
+		s_ThreadIndex = s_NoThreadIndex;
+	}
+
+	void JobSystem::run(JobFunction&& function, JobCounter* counter) {
+		if (!s_Running.load(std::memory_order_acquire)) {
+			function();
+			return;
+		}
+
+		if (s_ThreadIndex == s_NoThreadIndex) {
+			std::unique_lock<std::mutex> lock(s_ExternalMutex);
+
+			Job* job = acquireJob(s_ExternalJobPool, s_NextExternalJob);
+			if (!job) {
+				lock.unlock();
+				function();
+				return;
+			}
+
+			if (counter) {
+				counter->Pending.fetch_add(1, std::memory_order_relaxed);
+			}
+			job->Function = std::move(function);
+			job->Counter = counter;
+			s_ExternalJobs.push_back(job);
+		}
+		else {
+			auto& self = *s_Threads[s_ThreadIndex];
+
+			Job* job = acquireJob(self.JobPool.get(), self.NextJob);
+			if (!job) {
+				function();
+				return;
+			}
+
+			if (counter) {
+				counter->Pending.fetch_add(1, std::memory_order_relaxed);
+			}
+			job->Function = std::move(function);
+			job->Counter = counter;
+
+			if (!self.Deque.push(job)) {
+				execute(job);
+				return;
+			}
+		}
+
+		wakeWorkers();
+	}
+
+	void JobSystem::wait(JobCounter& counter) {
+		VI_PROFILE_FUNCTION();
+
+		while (!counter.isDone()) {
+			Job* job = s_ThreadIndex != s_NoThreadIndex ? findJob() : nullptr;
+			if (job) {
+				execute(job);
+			}
+			else {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	uint32_t JobSystem::getWorkerCount() {
+		return static_cast<uint32_t>(s_Workers.size());
+	}
+}
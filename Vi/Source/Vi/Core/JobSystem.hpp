@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Vi/Core/Base.hpp"
+#include "Vi/Core/InplaceFunction.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+namespace Vi {
+    // Tracks a group of jobs, decremented as each job of the group finishes
+    struct JobCounter {
+        std::atomic<uint32_t> Pending{ 0 };
+
+        [[nodiscard]] bool isDone() const {
+            return Pending.load(std::memory_order_acquire) == 0;
+        }
+    };
+
+    // Work-stealing scheduler. Every worker and the main thread own a deque, idle threads steal from the others.
+    class JobSystem {
+    public:
+        using JobFunction = InplaceFunction<void()>;
+
+        // workerCount of 0 uses one worker per hardware thread besides the main thread
+        static void init(uint32_t workerCount = 0);
+        static void shutdown();
+
+        // Jobs run inline when the job system is not initialized
+        static void run(JobFunction&& function, JobCounter* counter = nullptr);
+
+        // Executes other jobs while waiting, so it is safe to call from inside a job
+        static void wait(JobCounter& counter);
+
+        // Calls function(index) for every index in [0, count), split into batches of batchSize, and waits for all of them
+        template<typename Function>
+        static void parallelFor(uint32_t count, uint32_t batchSize, const Function& function) {
+            if (count == 0) {
+                return;
+            }
+
+            batchSize = batchSize == 0 ? 1 : batchSize;
+
+            JobCounter counter;
+            for (uint32_t begin = 0; begin < count; begin += batchSize) {
+                const uint32_t end = begin + batchSize < count ? begin + batchSize : count;
+
+                run([&function, begin, end]() {
+                    for (uint32_t index = begin; index < end; index++) {
+                        function(index);
+                    }
+                }, &counter);
+            }
+
+            wait(counter);
+        }
+
+        [[nodiscard]] static uint32_t getWorkerCount();
+    };
+}
@@ -2,6 +2,6 @@
 #include "Vi/Core/Layer.hpp"
 
 namespace Vi {
-    Layer::Layer(std::string layerName): m_DebugName(std::move(layerName)) {
+    Layer::Layer(std::string layerName, LayerPhaseFlags phases): m_DebugName(std::move(layerName)), m_Phases(phases) {
     }
 }
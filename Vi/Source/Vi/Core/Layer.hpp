@@ -2,16 +2,44 @@
 #include "Vi/Core/Base.hpp"
 #include "Vi/Core/Timestep.hpp"
 #include "Vi/Event/Event.hpp"
+#include "Vi/Renderer/RenderPacket.hpp"
 
 namespace Vi {
+    using LayerPhaseFlags = uint32_t;
+
+    // Number of distinct phase bits, kept out of the flag enum so it is never mistaken for a phase
+    constexpr uint32_t LayerPhaseCount{ 6 };
+
+    // Callbacks a layer implements, the LayerStack only dispatches the ones a layer registered for
+    namespace LayerPhase {
+        enum : LayerPhaseFlags {
+            None                = 0,
+            Update              = BIT(0),
+            FixedUpdate         = BIT(1),
+            Render              = BIT(2),
+            BuildRenderPacket   = BIT(3),
+            ImGuiRender         = BIT(4),
+            Event               = BIT(5),
+
+            All                 = BIT(LayerPhaseCount) - 1
+        };
+    }
+
+    // Bit per piece of shared state a layer touches, the meaning of each bit is up to the application
+    using LayerResourceMask = uint64_t;
+
     class Layer {
     public:
-        Layer(std::string layerName = "Layer");
+        Layer(std::string layerName = "Layer", LayerPhaseFlags phases = LayerPhase::All);
         virtual ~Layer() = default;
 
         virtual void onAttach() {}
         virtual void onDetach() {}
         virtual void onUpdate(Timestep ts) {}
+        virtual void onFixedUpdate(Timestep ts) {}
+        virtual void onRender(float alpha) {}
+        // Replaces onRender when rendering is pipelined, commands run later on the render thread
+        virtual void onBuildRenderPacket(RenderPacket& packet) {}
         virtual void onImGuiRender() {}
         virtual void onEvent(Event& event) {}
 
@@ -19,7 +47,46 @@ namespace Vi {
             return m_DebugName;
         }
 
+        [[nodiscard]] LayerPhaseFlags getPhases() const {
+            return m_Phases;
+        }
+
+        [[nodiscard]] bool hasDeclaredAccess() const {
+            return m_AccessDeclared;
+        }
+
+        [[nodiscard]] LayerResourceMask getReads() const {
+            return m_Reads;
+        }
+
+        [[nodiscard]] LayerResourceMask getWrites() const {
+            return m_Writes;
+        }
+
+        // Whether onUpdate of the two layers has to stay in stack order
+        [[nodiscard]] bool conflictsWith(const Layer& other) const {
+            if (!m_AccessDeclared || !other.m_AccessDeclared) {
+                return true;
+            }
+
+            return (m_Writes & (other.m_Reads | other.m_Writes)) || (other.m_Writes & m_Reads);
+        }
+
     protected:
+        // Layers that declare their access may have onUpdate called on a worker thread, concurrently with
+        // other layers they do not conflict with. Layers that never declare it always update alone.
+        void declareAccess(LayerResourceMask reads, LayerResourceMask writes) {
+            m_Reads = reads;
+            m_Writes = writes;
+            m_AccessDeclared = true;
+        }
+
         std::string m_DebugName;
+        LayerPhaseFlags m_Phases;
+
+    private:
+        LayerResourceMask m_Reads{ 0 };
+        LayerResourceMask m_Writes{ 0 };
+        bool m_AccessDeclared{ false };
     };
 }
@@ -1,39 +1,176 @@
 #include "vipch.hpp"
 #include "Vi/Core/LayerStack.hpp"
 
+#include <bit>
+
 namespace Vi {
-    LayerStack::~LayerStack() {
-		for (auto* layer : m_Layers) {
+	namespace {
+		Scope<Layer> extract(std::vector<Scope<Layer>>& layers, Layer* layer) {
+			const auto it = std::find_if(layers.begin(), layers.end(), [layer](const Scope<Layer>& entry) { return entry.get() == layer; });
+			if (it == layers.end()) {
+				return nullptr;
+			}
+
+			auto result = std::move(*it);
+			layers.erase(it);
+			return result;
+		}
+	}
+
+	LayerStack::~LayerStack() {
+		// Layers still waiting in m_PendingChanges were never attached
+		for (auto& layer : m_Layers) {
 			layer->onDetach();
-			delete layer;
 		}
-    }
 
-	void LayerStack::pushLayer(Layer* layer) {
-		m_Layers.emplace(m_Layers.begin() + m_LayerInsertIndex, layer);
-		m_LayerInsertIndex++;
+		for (auto& overlay : m_Overlays) {
+			overlay->onDetach();
+		}
+	}
+
+	Layer* LayerStack::pushLayer(Scope<Layer> layer) {
+		auto* pushed = layer.get();
+		std::scoped_lock<std::mutex> lock(m_PendingChangesMutex);
+		m_PendingChanges.push_back({ ChangeType::PushLayer, std::move(layer) });
+		return pushed;
+	}
+
+	Layer* LayerStack::pushOverlay(Scope<Layer> overlay) {
+		auto* pushed = overlay.get();
+		std::scoped_lock<std::mutex> lock(m_PendingChangesMutex);
+		m_PendingChanges.push_back({ ChangeType::PushOverlay, std::move(overlay) });
+		return pushed;
 	}
 
-	void LayerStack::pushOverlay(Layer* overlay) {
-		m_Layers.emplace_back();
+	void LayerStack::popLayer(Layer* layer) {
+		std::scoped_lock<std::mutex> lock(m_PendingChangesMutex);
+		m_PendingChanges.push_back({ ChangeType::PopLayer, nullptr, layer });
 	}
 
-	void LayerStack::popLayer(Layer* layer)
-	{
-		if (const auto it = std::find(m_Layers.begin(), m_Layers.begin() + m_LayerInsertIndex, layer); it != m_Layers.begin() + m_LayerInsertIndex)
+	void LayerStack::popOverlay(Layer* overlay) {
+		std::scoped_lock<std::mutex> lock(m_PendingChangesMutex);
+		m_PendingChanges.push_back({ ChangeType::PopOverlay, nullptr, overlay });
+	}
+
+	bool LayerStack::applyPendingChanges() {
 		{
+			std::scoped_lock<std::mutex> lock(m_PendingChangesMutex);
+			if (m_PendingChanges.empty()) {
+				return false;
+			}
+
+			// Callbacks below may request further changes, those wait for the next apply
+			std::swap(m_PendingChanges, m_ApplyingChanges);
+		}
+
+		VI_PROFILE_FUNCTION();
+
+		size_t pushedLayers{ 0 };
+		size_t pushedOverlays{ 0 };
+		for (const auto& change : m_ApplyingChanges) {
+			pushedLayers += change.Type == ChangeType::PushLayer;
+			pushedOverlays += change.Type == ChangeType::PushOverlay;
+		}
+		m_Layers.reserve(m_Layers.size() + pushedLayers);
+		m_Overlays.reserve(m_Overlays.size() + pushedOverlays);
+
+		for (auto& change : m_ApplyingChanges) {
+			switch (change.Type) {
+			case ChangeType::PushLayer:
+				m_Attached.push_back(m_Layers.emplace_back(std::move(change.Pushed)).get());
+				break;
+			case ChangeType::PushOverlay:
+				m_Attached.push_back(m_Overlays.emplace_back(std::move(change.Pushed)).get());
+				break;
+			case ChangeType::PopLayer:
+			case ChangeType::PopOverlay: {
+				auto popped = extract(change.Type == ChangeType::PopLayer ? m_Layers : m_Overlays, change.Popped);
+				if (!popped) {
+					VI_CORE_WARN("Popping layer that is not on the stack");
+					break;
+				}
+
+				// Pushed and popped within the same batch, it was never attached
+				if (const auto it = std::find(m_Attached.begin(), m_Attached.end(), popped.get()); it != m_Attached.end()) {
+					m_Attached.erase(it);
+					break;
+				}
+
+				m_Detached.emplace_back(std::move(popped));
+				break;
+			}
+			}
+		}
+		m_ApplyingChanges.clear();
+
+		rebuildDispatchLists();
+
+		for (auto& layer : m_Detached) {
 			layer->onDetach();
-			m_Layers.erase(it);
-			m_LayerInsertIndex--;
 		}
+		m_Detached.clear();
+
+		for (auto* layer : m_Attached) {
+			layer->onAttach();
+		}
+		m_Attached.clear();
+
+		return true;
 	}
 
-	void LayerStack::popOverlay(Layer* overlay)
-	{
-		if (const auto it = std::find(m_Layers.begin() + m_LayerInsertIndex, m_Layers.end(), overlay); it != m_Layers.end())
-		{
-			overlay->onDetach();
-			m_Layers.erase(it);
+	const std::vector<Layer*>& LayerStack::getLayers(LayerPhaseFlags phase) {
+		VI_CORE_ASSERT(std::has_single_bit(phase) && (phase & LayerPhase::All), "getLayers expects exactly one phase!");
+
+		return m_DispatchLists[std::countr_zero(phase)];
+	}
+
+	void LayerStack::rebuildDispatchLists() {
+		VI_PROFILE_FUNCTION();
+
+		for (auto& list : m_DispatchLists) {
+			list.clear();
+		}
+		m_AllLayers.clear();
+
+		const auto registerLayer = [this](Layer* layer) {
+			m_AllLayers.push_back(layer);
+			for (uint32_t index = 0; index < LayerPhaseCount; index++) {
+				if (layer->getPhases() & BIT(index)) {
+					m_DispatchLists[index].push_back(layer);
+				}
+			}
+		};
+
+		for (auto& layer : m_Layers) {
+			registerLayer(layer.get());
+		}
+
+		for (auto& overlay : m_Overlays) {
+			registerLayer(overlay.get());
+		}
+
+		rebuildUpdateBatches();
+	}
+
+	void LayerStack::rebuildUpdateBatches() {
+		m_UpdateBatches.clear();
+
+		// Every layer goes into the first batch after the last one holding a layer it conflicts with,
+		// which keeps conflicting layers in stack order
+		for (auto* layer : m_DispatchLists[std::countr_zero<LayerPhaseFlags>(LayerPhase::Update)]) {
+			size_t target = m_UpdateBatches.size();
+			while (target > 0) {
+				const auto& batch = m_UpdateBatches[target - 1];
+				if (std::any_of(batch.begin(), batch.end(), [layer](const Layer* other) { return layer->conflictsWith(*other); })) {
+					break;
+				}
+				target--;
+			}
+
+			if (target == m_UpdateBatches.size()) {
+				m_UpdateBatches.emplace_back();
+			}
+			m_UpdateBatches[target].push_back(layer);
 		}
 	}
 }
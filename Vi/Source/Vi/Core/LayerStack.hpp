@@ -1,52 +1,75 @@
 #pragma once
 #include "Vi/Core/Layer.hpp"
 
+#include <array>
+#include <mutex>
 #include <vector>
 
 namespace Vi {
+    // Pushes and pops are recorded and only applied in applyPendingChanges, so they are safe to request while the
+    // stack is being iterated, from any thread. onDetach and onAttach are called in one batch after all changes have been applied.
     class LayerStack {
     public:
         LayerStack() = default;
         ~LayerStack();
 
-        void pushLayer(Layer* layer);
-        void pushOverlay(Layer* overlay);
+        Layer* pushLayer(Scope<Layer> layer);
+        Layer* pushOverlay(Scope<Layer> overlay);
+        // The layer is detached and destroyed when the change is applied
         void popLayer(Layer* layer);
         void popOverlay(Layer* overlay);
 
-        [[nodiscard]] std::vector<Layer*>::iterator begin() {
-            return m_Layers.begin();
-        }
+        // Returns whether the stack changed
+        bool applyPendingChanges();
 
-        [[nodiscard]] std::vector<Layer*>::iterator end() {
-            return m_Layers.end();
-        }
+        // Layers registered for a single phase in stack order, overlays last
+        [[nodiscard]] const std::vector<Layer*>& getLayers(LayerPhaseFlags phase);
 
-        [[nodiscard]] std::vector<Layer*>::reverse_iterator rbegin() {
-            return m_Layers.rbegin();
+        // Every layer in stack order, overlays last
+        [[nodiscard]] const std::vector<Layer*>& getAllLayers() const {
+            return m_AllLayers;
         }
 
-        [[nodiscard]] std::vector<Layer*>::reverse_iterator rend() {
-            return m_Layers.rend();
+        // Update layers grouped so that layers within one batch do not conflict with each other,
+        // batches have to run one after another
+        [[nodiscard]] const std::vector<std::vector<Layer*>>& getUpdateBatches() const {
+            return m_UpdateBatches;
         }
 
-        [[nodiscard]] std::vector<Layer*>::const_iterator begin() const {
-            return m_Layers.begin();
+        [[nodiscard]] size_t size() const {
+            return m_Layers.size() + m_Overlays.size();
         }
 
-        [[nodiscard]] std::vector<Layer*>::const_iterator end() const {
-            return m_Layers.end();
-        }
+    private:
+        enum class ChangeType {
+            PushLayer,
+            PushOverlay,
+            PopLayer,
+            PopOverlay
+        };
 
-        [[nodiscard]] std::vector<Layer*>::const_reverse_iterator rbegin() const {
-            return m_Layers.rbegin();
-        }
+        struct Change {
+            ChangeType Type;
+            Scope<Layer> Pushed;
+            Layer* Popped{ nullptr };
+        };
 
-        [[nodiscard]] std::vector<Layer*>::const_reverse_iterator rend() const {
-            return m_Layers.rend();
-        }
-    private:
-        std::vector<Layer*> m_Layers;
-        uint32_t m_LayerInsertIndex{ 0 };
+        void rebuildDispatchLists();
+        void rebuildUpdateBatches();
+
+        std::vector<Scope<Layer>> m_Layers;
+        std::vector<Scope<Layer>> m_Overlays;
+
+        std::vector<Change> m_PendingChanges;
+        std::mutex m_PendingChangesMutex;
+        // Scratch storage reused between applies
+        std::vector<Change> m_ApplyingChanges;
+        std::vector<Layer*> m_Attached;
+        std::vector<Scope<Layer>> m_Detached;
+
+        // Flat per-phase arrays, rebuilt only after the stack changed
+        std::array<std::vector<Layer*>, LayerPhaseCount> m_DispatchLists;
+        std::vector<Layer*> m_AllLayers;
+        std::vector<std::vector<Layer*>> m_UpdateBatches;
     };
 }
@@ -1,29 +1,374 @@
 #include "vipch.hpp"
 #include "Vi/Core/Log.hpp"
+#include "Vi/Core/MPSCQueue.hpp"
 
+#include <spdlog/details/log_msg_buffer.h>
+#include <spdlog/sinks/sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/basic_file_sink.h>
 
+#include <csignal>
+#include <exception>
+#include <thread>
+
 namespace Vi {
 	Ref<spdlog::logger> Log::s_CoreLogger;
 	Ref<spdlog::logger> Log::s_ClientLogger;
 
-	void Log::init() {
+	namespace {
+		// Forwards messages to the real sinks from a background thread. Logging threads copy the message into a
+		// lock-free ring, formatting the pattern and file I/O happen on the writer thread.
+		class AsyncSink final: public spdlog::sinks::sink {
+		public:
+			// Pinned messages ignore the overflow policy, they block on a full ring and are never discarded as the oldest
+			using PinnedPredicate = bool (*)(const spdlog::details::log_msg&);
+
+			AsyncSink(std::vector<spdlog::sink_ptr> sinks, LogOverflowPolicy overflowPolicy, PinnedPredicate isPinned = nullptr)
+				: m_Sinks(std::move(sinks)), m_OverflowPolicy(overflowPolicy), m_IsPinned(isPinned) {
+				m_Running.store(true, std::memory_order_release);
+				m_Writer = std::thread([this]() { writerLoop(); });
+			}
+
+			~AsyncSink() override {
+				stop();
+			}
+
+			void log(const spdlog::details::log_msg& message) override {
+				if (!m_Running.load(std::memory_order_acquire)) {
+					write(message);
+					return;
+				}
+
+				spdlog::details::log_msg_buffer buffer(message);
+				const auto overflowPolicy = isPinned(message) ? LogOverflowPolicy::Block : m_OverflowPolicy;
+				while (!m_Queue.tryPush(buffer)) {
+					switch (overflowPolicy) {
+					case LogOverflowPolicy::Block:
+						wakeWriter();
+						std::this_thread::yield();
+						break;
+					case LogOverflowPolicy::Drop:
+						m_Dropped.fetch_add(1, std::memory_order_relaxed);
+						return;
+					case LogOverflowPolicy::DropOldest:
+						discardOldest();
+						break;
+					}
+				}
+
+				m_Pushed.fetch_add(1, std::memory_order_release);
+				wakeWriter();
+			}
+
+			void flush() override {
+				waitUntilWritten(std::chrono::steady_clock::time_point::max());
+				flushSinks();
+			}
+
+			// Best effort only, this runs from a signal handler where hardly anything is safe to call. The writer gets a moment
+			// to drain the ring unless it is the thread that crashed, the sinks are only flushed when no thread is inside them.
+			void flushOnCrash() {
+				const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+				if (std::this_thread::get_id() != m_Writer.get_id()) {
+					waitUntilWritten(deadline);
+				}
+
+				// The crashing thread may hold the sinks itself, give up instead of waiting for it
+				while (!tryLockSinks()) {
+					if (std::chrono::steady_clock::now() >= deadline) {
+						return;
+					}
+					std::this_thread::yield();
+				}
+
+				for (auto& sink : m_Sinks) {
+					sink->flush();
+				}
+				unlockSinks();
+			}
+
+			void set_pattern(const std::string& pattern) override {
+				for (auto& sink : m_Sinks) {
+					sink->set_pattern(pattern);
+				}
+			}
+
+			void set_formatter(std::unique_ptr<spdlog::formatter> formatter) override {
+				for (auto& sink : m_Sinks) {
+					sink->set_formatter(formatter->clone());
+				}
+			}
+
+			void stop() {
+				if (!m_Running.exchange(false, std::memory_order_acq_rel)) {
+					return;
+				}
+
+				m_Epoch.fetch_add(1, std::memory_order_seq_cst);
+				m_Epoch.notify_all();
+				m_Writer.join();
+				flushSinks();
+			}
+
+			[[nodiscard]] uint64_t getDroppedCount() const {
+				return m_Dropped.load(std::memory_order_relaxed);
+			}
+
+		private:
+			static constexpr std::size_t s_QueueCapacity{ 8192 };
+
+			void writerLoop() {
+				VI_MEMORY_TAG(Log);
+				spdlog::details::log_msg_buffer buffer;
+
+				for (;;) {
+					const uint32_t epoch = m_Epoch.load(std::memory_order_acquire);
+					if (popOne(buffer)) {
+						write(buffer);
+						m_Written.fetch_add(1, std::memory_order_release);
+						continue;
+					}
+
+					// Drained, the queue is only left behind once logging has stopped
+					if (!m_Running.load(std::memory_order_acquire)) {
+						break;
+					}
+
+					m_WriterSleeping.store(true, std::memory_order_seq_cst);
+					m_Epoch.wait(epoch, std::memory_order_acquire);
+					m_WriterSleeping.store(false, std::memory_order_relaxed);
+				}
+			}
+
+			bool popOne(spdlog::details::log_msg_buffer& buffer) {
+				// The ring has a single consumer, only producers dropping the oldest message share that role with the writer
+				if (m_OverflowPolicy != LogOverflowPolicy::DropOldest) {
+					return m_Queue.tryPop(buffer);
+				}
+
+				std::scoped_lock<std::mutex> lock(m_ConsumerMutex);
+				return m_Queue.tryPop(buffer);
+			}
+
+			void discardOldest() {
+				spdlog::details::log_msg_buffer oldest;
+				if (popOne(oldest)) {
+					// Written ahead of whatever the writer is busy with, nothing queued before it depends on it
+					if (isPinned(oldest)) {
+						write(oldest);
+					}
+					else {
+						m_Dropped.fetch_add(1, std::memory_order_relaxed);
+					}
+					m_Written.fetch_add(1, std::memory_order_release);
+				}
+			}
+
+			[[nodiscard]] bool isPinned(const spdlog::details::log_msg& message) const {
+				return m_IsPinned && m_IsPinned(message);
+			}
+
+			void write(const spdlog::details::log_msg& message) {
+				lockSinks();
+				for (auto& sink : m_Sinks) {
+					if (sink->should_log(message.level)) {
+						sink->log(message);
+					}
+				}
+				unlockSinks();
+			}
+
+			void flushSinks() {
+				lockSinks();
+				for (auto& sink : m_Sinks) {
+					sink->flush();
+				}
+				unlockSinks();
+			}
+
+			// A flag instead of a mutex so the crash handler can try to take it from any thread without blocking
+			bool tryLockSinks() {
+				return !m_SinksLocked.exchange(true, std::memory_order_acquire);
+			}
+
+			void lockSinks() {
+				while (!tryLockSinks()) {
+					std::this_thread::yield();
+				}
+			}
+
+			void unlockSinks() {
+				m_SinksLocked.store(false, std::memory_order_release);
+			}
+
+			void wakeWriter() {
+				m_Epoch.fetch_add(1, std::memory_order_seq_cst);
+				if (m_WriterSleeping.load(std::memory_order_seq_cst)) {
+					m_Epoch.notify_one();
+				}
+			}
+
+			void waitUntilWritten(std::chrono::steady_clock::time_point deadline) {
+				const uint64_t target = m_Pushed.load(std::memory_order_acquire);
+				while (m_Running.load(std::memory_order_acquire) && m_Written.load(std::memory_order_acquire) < target && std::chrono::steady_clock::now() < deadline) {
+					wakeWriter();
+					std::this_thread::yield();
+				}
+			}
+
+			std::vector<spdlog::sink_ptr> m_Sinks;
+			LogOverflowPolicy m_OverflowPolicy;
+			PinnedPredicate m_IsPinned;
+
+			MPSCQueue<spdlog::details::log_msg_buffer, s_QueueCapacity> m_Queue;
+			std::mutex m_ConsumerMutex;
+			std::atomic<bool> m_SinksLocked{ false };
+			std::atomic<uint64_t> m_Pushed{ 0 };
+			std::atomic<uint64_t> m_Written{ 0 };
+			std::atomic<uint64_t> m_Dropped{ 0 };
+
+			std::atomic<bool> m_Running{ false };
+			std::atomic<uint32_t> m_Epoch{ 0 };
+			std::atomic<bool> m_WriterSleeping{ false };
+			std::thread m_Writer;
+		};
+
+		std::vector<Ref<AsyncSink>> s_AsyncSinks;
+
+		// Whatever was installed before, e.g. a crash reporter, runs after the flush
+		struct CrashSignal {
+			int Signal;
+			void (*Previous)(int);
+		};
+
+		std::array<CrashSignal, 4> s_CrashSignals{ {
+			{ SIGSEGV, SIG_DFL },
+			{ SIGABRT, SIG_DFL },
+			{ SIGFPE, SIG_DFL },
+			{ SIGILL, SIG_DFL }
+		} };
+		std::terminate_handler s_PreviousTerminateHandler{ nullptr };
+		bool s_CrashHandlersInstalled{ false };
+
+		std::atomic<bool> s_CrashFlushed{ false };
+
+		// Not async-signal-safe, a crash is already past the point where anything is guaranteed. Only the first crash flushes.
+		void flushAfterCrash() {
+			if (s_CrashFlushed.exchange(true)) {
+				return;
+			}
+
+			for (auto& sink : s_AsyncSinks) {
+				sink->flushOnCrash();
+			}
+		}
+
+		void onCrashSignal(int signal) {
+			flushAfterCrash();
+
+			auto previous = SIG_DFL;
+			for (const auto& crashSignal : s_CrashSignals) {
+				if (crashSignal.Signal == signal) {
+					previous = crashSignal.Previous;
+				}
+			}
+
+			std::signal(signal, previous);
+			std::raise(signal);
+		}
+
+		void onTerminate() {
+			flushAfterCrash();
+
+			if (s_PreviousTerminateHandler) {
+				s_PreviousTerminateHandler();
+			}
+			std::abort();
+		}
+	}
+
+	void Log::init(const LogSpecification& specification) {
+		VI_MEMORY_TAG(Log);
+		const bool binary = specification.FileFormat == LogFileFormat::Binary;
+		LogLimiter::configure(specification.SiteRateLimit, specification.SuppressDuplicates);
+
 		std::vector<spdlog::sink_ptr> logSinks;
 		logSinks.emplace_back(std::make_shared<spdlog::sinks::stdout_color_sink_mt>());
-		logSinks.emplace_back(std::make_shared<spdlog::sinks::basic_file_sink_mt>("Vi.log", true));
-
 		logSinks[0]->set_pattern("%^[%T] %n: %v%$");
-		logSinks[1]->set_pattern("[%T] [%l] %n: %v");
+
+		if (!binary) {
+			logSinks.emplace_back(std::make_shared<spdlog::sinks::basic_file_sink_mt>(specification.FilePath, true));
+			logSinks[1]->set_pattern("[%T] [%l] %n: %v");
+		}
+
+		// Asynchronous mode only flushes on errors, those wait until everything before them has been written
+		auto flushLevel = spdlog::level::trace;
+		if (specification.Async) {
+			s_AsyncSinks.emplace_back(std::make_shared<AsyncSink>(std::move(logSinks), specification.OverflowPolicy));
+			logSinks = { s_AsyncSinks.back() };
+			flushLevel = spdlog::level::err;
+
+			// Installing twice would make the handlers chain to themselves
+			if (!s_CrashHandlersInstalled) {
+				s_CrashHandlersInstalled = true;
+				s_PreviousTerminateHandler = std::set_terminate(onTerminate);
+				for (auto& crashSignal : s_CrashSignals) {
+					const auto previous = std::signal(crashSignal.Signal, onCrashSignal);
+					crashSignal.Previous = previous == SIG_ERR ? SIG_DFL : previous;
+				}
+			}
+		}
+
+		if (binary) {
+			auto binarySink = BinaryLog::createFileSink(specification.FilePath);
+			if (specification.Async) {
+				s_AsyncSinks.emplace_back(std::make_shared<AsyncSink>(std::vector<spdlog::sink_ptr>{ binarySink }, specification.OverflowPolicy, &BinaryLog::isFormatRecord));
+				binarySink = s_AsyncSinks.back();
+			}
+			BinaryLog::init(binarySink, flushLevel);
+		}
+
+		// Text loggers only serve the console when the file is binary, their level keeps the macros from formatting below it
+		const auto textLevel = binary ? specification.ConsoleLevel : spdlog::level::trace;
 
 		s_CoreLogger = std::make_shared<spdlog::logger>("VI", begin(logSinks), end(logSinks));
 		spdlog::register_logger(s_CoreLogger);
-		s_CoreLogger->set_level(spdlog::level::trace);
-		s_CoreLogger->flush_on(spdlog::level::trace);
+		s_CoreLogger->set_level(textLevel);
+		s_CoreLogger->flush_on(flushLevel);
 
 		s_ClientLogger = std::make_shared<spdlog::logger>("APP", begin(logSinks), end(logSinks));
 		spdlog::register_logger(s_ClientLogger);
-		s_ClientLogger->set_level(spdlog::level::trace);
-		s_ClientLogger->flush_on(spdlog::level::trace);
+		s_ClientLogger->set_level(textLevel);
+		s_ClientLogger->flush_on(flushLevel);
+	}
+
+	void Log::shutdown() {
+		LogLimiter::reportSuppressed(true);
+
+		if (const uint64_t dropped = getDroppedMessageCount(); dropped > 0) {
+			VI_CORE_WARN("{0} log messages were dropped", dropped);
+		}
+
+		flush();
+		BinaryLog::shutdown();
+		for (auto& sink : s_AsyncSinks) {
+			sink->stop();
+		}
+	}
+
+	void Log::flush() {
+		s_CoreLogger->flush();
+		s_ClientLogger->flush();
+		if (BinaryLog::s_Logger) {
+			BinaryLog::s_Logger->flush();
+		}
+	}
+
+	uint64_t Log::getDroppedMessageCount() {
+		uint64_t dropped{ 0 };
+		for (const auto& sink : s_AsyncSinks) {
+			dropped += sink->getDroppedCount();
+		}
+		return dropped;
 	}
 }
@@ -11,10 +11,47 @@
 #include <spdlog/fmt/ostr.h>
 #pragma warning(pop)
 
+#include "Vi/Core/BinaryLog.hpp"
+#include "Vi/Core/LogLimiter.hpp"
+
 namespace Vi {
+	// What a caller does when the asynchronous log ring is full
+	enum class LogOverflowPolicy {
+		Block,		// Waits for the background thread, nothing is lost
+		Drop,		// Discards the new message
+		DropOldest	// Discards the oldest queued message to make room
+	};
+
+	enum class LogFileFormat {
+		Text,
+		// Format ids and raw argument values, decoded offline with ViLogDecoder
+		Binary
+	};
+
+	struct LogSpecification {
+		// Callers only copy the message into a preallocated ring, a background thread formats and writes it
+		bool Async{ true };
+		LogOverflowPolicy OverflowPolicy{ LogOverflowPolicy::Block };
+		std::string FilePath{ "Vi.log" };
+		LogFileFormat FileFormat{ LogFileFormat::Text };
+		// The console always prints text, with a binary file it only gets messages from this level on
+		spdlog::level::level_enum ConsoleLevel{ spdlog::level::info };
+
+		// Messages per second a single log site may write, 0 disables the limit. Errors and critical messages are exempt.
+		uint32_t SiteRateLimit{ 20 };
+		// Drops a message identical to the previous one of its site if it comes within a second, except errors and critical messages
+		bool SuppressDuplicates{ true };
+	};
+
 	class Log {
 	public:
-		static void init();
+		static void init(const LogSpecification& specification = {});
+		// Writes out everything still queued and stops the background thread, later messages are written synchronously
+		static void shutdown();
+		// Blocks until every queued message is written and the sinks are flushed
+		static void flush();
+
+		[[nodiscard]] static uint64_t getDroppedMessageCount();
 
 		static Ref<spdlog::logger>& getCoreLogger() { return s_CoreLogger; }
 		static Ref<spdlog::logger>& getClientLogger() { return s_ClientLogger; }
@@ -23,6 +60,47 @@ namespace Vi {
 		static Ref<spdlog::logger> s_ClientLogger;
 	};
 
+	namespace Internal {
+		// Only named inside sizeof by the disabled log macros, their arguments count as used without being evaluated
+		template<typename... Args>
+		constexpr int discardLogArguments(const Args&...) {
+			return 0;
+		}
+
+		// The log macros evaluate their arguments once into these, the duplicate check, the text loggers
+		// and the binary log all read the same values
+		template<typename... Args>
+		void writeLog(LogSite& site, const Ref<spdlog::logger>& logger, spdlog::level::level_enum level, bool text, bool binary, spdlog::format_string_t<const Args&...> format, const Args&... args) {
+			const spdlog::string_view_t view = format;
+			const std::string_view formatView(view.data(), view.size());
+			if (!LogLimiter::allowUnique(site, level, formatView, args...)) {
+				return;
+			}
+
+			if (text) {
+				logger->log(level, format, args...);
+			}
+			if (binary) {
+				BinaryLog::writeMessage(site, logger, level, formatView, args...);
+			}
+		}
+
+		// A single argument is logged as it is, it does not have to be a format string
+		template<typename T>
+		void writeLog(LogSite& site, const Ref<spdlog::logger>& logger, spdlog::level::level_enum level, bool text, bool binary, const T& message) {
+			if (!LogLimiter::allowUnique(site, level, message)) {
+				return;
+			}
+
+			if (text) {
+				logger->log(level, message);
+			}
+			if (binary) {
+				BinaryLog::write(site, logger, level, message);
+			}
+		}
+	}
+
 }
 
 template<typename OStream, glm::length_t L, typename T, glm::qualifier Q>
@@ -40,16 +118,78 @@ inline OStream& operator<<(OStream& os, glm::qua<T, Q> quaternion) {
 	return os << glm::to_string(quaternion);
 }
 
-// Core log macros
-#define VI_CORE_TRACE(...)    ::Vi::Log::getCoreLogger()->trace(__VA_ARGS__)
-#define VI_CORE_INFO(...)     ::Vi::Log::getCoreLogger()->info(__VA_ARGS__)
-#define VI_CORE_WARN(...)     ::Vi::Log::getCoreLogger()->warn(__VA_ARGS__)
-#define VI_CORE_ERROR(...)    ::Vi::Log::getCoreLogger()->error(__VA_ARGS__)
-#define VI_CORE_CRITICAL(...) ::Vi::Log::getCoreLogger()->critical(__VA_ARGS__)
-
-// Client log macros
-#define VI_TRACE(...)         ::Vi::Log::getClientLogger()->trace(__VA_ARGS__)
-#define VI_INFO(...)          ::Vi::Log::getClientLogger()->info(__VA_ARGS__)
-#define VI_WARN(...)          ::Vi::Log::getClientLogger()->warn(__VA_ARGS__)
-#define VI_ERROR(...)         ::Vi::Log::getClientLogger()->error(__VA_ARGS__)
-#define VI_CRITICAL(...)      ::Vi::Log::getClientLogger()->critical(__VA_ARGS__)
+// Messages below VI_LOG_LEVEL are removed at compile time, their arguments are never evaluated.
+// Defaults to everything in Debug and to info and above otherwise, define VI_LOG_LEVEL to override.
+#define VI_LOG_LEVEL_TRACE    0
+#define VI_LOG_LEVEL_INFO     2
+#define VI_LOG_LEVEL_WARN     3
+#define VI_LOG_LEVEL_ERROR    4
+#define VI_LOG_LEVEL_CRITICAL 5
+#define VI_LOG_LEVEL_OFF      6
+
+#ifndef VI_LOG_LEVEL
+#ifdef VI_DEBUG
+#define VI_LOG_LEVEL VI_LOG_LEVEL_TRACE
+#else
+#define VI_LOG_LEVEL VI_LOG_LEVEL_INFO
+#endif
+#endif
+
+// Enabled sites check the runtime level of the logger and the rate limit of the site before formatting or evaluating
+// any argument, the arguments are then evaluated exactly once. The text loggers and the binary log are checked separately,
+// so a binary file does not pay for console formatting.
+#define VI_INTERNAL_LOG(logger, level, ...) do { \
+		const bool viLogText = logger->should_log(level); \
+		const bool viLogBinary = ::Vi::BinaryLog::shouldLog(level); \
+		if (viLogText || viLogBinary) { \
+			static ::Vi::LogSite viLogSite{ __FILE__, static_cast<uint32_t>(__LINE__) }; \
+			if (::Vi::LogLimiter::allowRate(viLogSite, level)) { \
+				::Vi::Internal::writeLog(viLogSite, logger, level, viLogText, viLogBinary, __VA_ARGS__); \
+			} \
+		} \
+	} while (0)
+
+#define VI_INTERNAL_CORE_LOG(level, ...) VI_INTERNAL_LOG(::Vi::Log::getCoreLogger(), level, __VA_ARGS__)
+#define VI_INTERNAL_CLIENT_LOG(level, ...) VI_INTERNAL_LOG(::Vi::Log::getClientLogger(), level, __VA_ARGS__)
+#define VI_INTERNAL_LOG_DISABLED(...) do { (void)sizeof(::Vi::Internal::discardLogArguments(__VA_ARGS__)); } while (0)
+
+// Core and client log macros
+#if VI_LOG_LEVEL <= VI_LOG_LEVEL_TRACE
+#define VI_CORE_TRACE(...)    VI_INTERNAL_CORE_LOG(::spdlog::level::trace, __VA_ARGS__)
+#define VI_TRACE(...)         VI_INTERNAL_CLIENT_LOG(::spdlog::level::trace, __VA_ARGS__)
+#else
+#define VI_CORE_TRACE(...)    VI_INTERNAL_LOG_DISABLED(__VA_ARGS__)
+#define VI_TRACE(...)         VI_INTERNAL_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if VI_LOG_LEVEL <= VI_LOG_LEVEL_INFO
+#define VI_CORE_INFO(...)     VI_INTERNAL_CORE_LOG(::spdlog::level::info, __VA_ARGS__)
+#define VI_INFO(...)          VI_INTERNAL_CLIENT_LOG(::spdlog::level::info, __VA_ARGS__)
+#else
+#define VI_CORE_INFO(...)     VI_INTERNAL_LOG_DISABLED(__VA_ARGS__)
+#define VI_INFO(...)          VI_INTERNAL_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if VI_LOG_LEVEL <= VI_LOG_LEVEL_WARN
+#define VI_CORE_WARN(...)     VI_INTERNAL_CORE_LOG(::spdlog::level::warn, __VA_ARGS__)
+#define VI_WARN(...)          VI_INTERNAL_CLIENT_LOG(::spdlog::level::warn, __VA_ARGS__)
+#else
+#define VI_CORE_WARN(...)     VI_INTERNAL_LOG_DISABLED(__VA_ARGS__)
+#define VI_WARN(...)          VI_INTERNAL_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if VI_LOG_LEVEL <= VI_LOG_LEVEL_ERROR
+#define VI_CORE_ERROR(...)    VI_INTERNAL_CORE_LOG(::spdlog::level::err, __VA_ARGS__)
+#define VI_ERROR(...)         VI_INTERNAL_CLIENT_LOG(::spdlog::level::err, __VA_ARGS__)
+#else
+#define VI_CORE_ERROR(...)    VI_INTERNAL_LOG_DISABLED(__VA_ARGS__)
+#define VI_ERROR(...)         VI_INTERNAL_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if VI_LOG_LEVEL <= VI_LOG_LEVEL_CRITICAL
+#define VI_CORE_CRITICAL(...) VI_INTERNAL_CORE_LOG(::spdlog::level::critical, __VA_ARGS__)
+#define VI_CRITICAL(...)      VI_INTERNAL_CLIENT_LOG(::spdlog::level::critical, __VA_ARGS__)
+#else
+#define VI_CORE_CRITICAL(...) VI_INTERNAL_LOG_DISABLED(__VA_ARGS__)
+#define VI_CRITICAL(...)      VI_INTERNAL_LOG_DISABLED(__VA_ARGS__)
+#endif
@@ -0,0 +1,61 @@
+#include "vipch.hpp"
+#include "Vi/Core/LogLimiter.hpp"
+
+namespace Vi {
+	uint32_t LogLimiter::s_MessagesPerSecond{ 20 };
+	bool LogLimiter::s_SuppressDuplicates{ true };
+
+	namespace {
+		constexpr int64_t s_ReportInterval{ 5000 };
+
+		std::mutex s_SitesMutex;
+		LogSite* s_Sites{ nullptr };
+		std::atomic<int64_t> s_LastReport{ 0 };
+	}
+
+	void LogLimiter::configure(uint32_t messagesPerSecond, bool suppressDuplicates) {
+		s_MessagesPerSecond = messagesPerSecond;
+		s_SuppressDuplicates = suppressDuplicates;
+	}
+
+	void LogLimiter::registerSite(LogSite& site) {
+		std::scoped_lock<std::mutex> lock(s_SitesMutex);
+		if (site.Registered.load(std::memory_order_relaxed)) {
+			return;
+		}
+
+		site.Next = s_Sites;
+		s_Sites = &site;
+		site.Registered.store(true, std::memory_order_release);
+	}
+
+	void LogLimiter::reportSuppressed(bool force) {
+		const int64_t now = getMilliseconds();
+		int64_t last = s_LastReport.load(std::memory_order_relaxed);
+		if (force) {
+			s_LastReport.store(now, std::memory_order_relaxed);
+		}
+		else if (now - last < s_ReportInterval || !s_LastReport.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+			return;
+		}
+
+		// Bypasses the limiter, otherwise a burst of reports could suppress itself
+		static LogSite reportSite{ __FILE__, static_cast<uint32_t>(__LINE__) };
+		auto& logger = Log::getCoreLogger();
+
+		std::scoped_lock<std::mutex> lock(s_SitesMutex);
+		for (LogSite* site = s_Sites; site; site = site->Next) {
+			const uint32_t suppressed = site->Suppressed.exchange(0, std::memory_order_relaxed);
+			if (suppressed == 0) {
+				continue;
+			}
+
+			if (logger->should_log(spdlog::level::warn)) {
+				logger->warn("Suppressed {0} messages from {1}:{2}", suppressed, site->File, site->Line);
+			}
+			if (BinaryLog::shouldLog(spdlog::level::warn)) {
+				BinaryLog::write(reportSite, logger, spdlog::level::warn, "Suppressed {0} messages from {1}:{2}", suppressed, site->File, site->Line);
+			}
+		}
+	}
+}
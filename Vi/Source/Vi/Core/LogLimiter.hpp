@@ -0,0 +1,126 @@
+#pragma once
+
+#include "Vi/Core/BinaryLog.hpp"
+#include "Vi/Core/LogSite.hpp"
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace Vi {
+    // Keeps log sites that fire every frame from flooding the log. Each site may log a limited number of messages
+    // per second and a message identical to the previous one of its site is dropped for a second. What was dropped
+    // is reported per site by reportSuppressed(). Errors and critical messages are never limited.
+    class LogLimiter {
+    public:
+        static void configure(uint32_t messagesPerSecond, bool suppressDuplicates);
+
+        [[nodiscard]] static constexpr bool isLimited(spdlog::level::level_enum level) {
+            return level < spdlog::level::err;
+        }
+
+        // Cheap check done before any argument of the message is evaluated
+        [[nodiscard]] static bool allowRate(LogSite& site, spdlog::level::level_enum level) {
+            if (s_MessagesPerSecond == 0 || !isLimited(level)) {
+                return true;
+            }
+
+            if (!site.Registered.load(std::memory_order_acquire)) {
+                registerSite(site);
+            }
+
+            const int64_t now = getMilliseconds();
+            const int64_t window = now / 1000;
+            int64_t current = site.Window.load(std::memory_order_relaxed);
+            if (current != window && site.Window.compare_exchange_strong(current, window, std::memory_order_relaxed)) {
+                site.WindowCount.store(0, std::memory_order_relaxed);
+            }
+
+            if (site.WindowCount.fetch_add(1, std::memory_order_relaxed) < s_MessagesPerSecond) {
+                return true;
+            }
+
+            site.Suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        template<typename... Args>
+        [[nodiscard]] static bool allowUnique(LogSite& site, spdlog::level::level_enum level, const Args&... args) {
+            if (!s_SuppressDuplicates || !isLimited(level)) {
+                return true;
+            }
+
+            if (!site.Registered.load(std::memory_order_acquire)) {
+                registerSite(site);
+            }
+
+            // Arguments, the format string included, are hashed from their raw bytes without formatting them
+            uint64_t hash{ s_HashOffset };
+            (hashArgument(hash, args), ...);
+
+            const int64_t now = getMilliseconds();
+            if (site.LastHash.exchange(hash, std::memory_order_relaxed) == hash && now - site.LastTime.load(std::memory_order_relaxed) < s_DuplicateInterval) {
+                site.Suppressed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            site.LastTime.store(now, std::memory_order_relaxed);
+            return true;
+        }
+
+        // Logs how many messages each site dropped since the last report. Runs at most every few seconds unless forced,
+        // cheap enough to call every frame.
+        static void reportSuppressed(bool force = false);
+
+    private:
+        static constexpr int64_t s_DuplicateInterval{ 1000 };
+        static constexpr uint64_t s_HashOffset{ 14695981039346656037ull };
+        static constexpr uint64_t s_HashPrime{ 1099511628211ull };
+
+        // FNV-1a
+        static void hashBytes(uint64_t& hash, const void* data, size_t size) {
+            const auto* bytes = static_cast<const unsigned char*>(data);
+            for (size_t index = 0; index < size; index++) {
+                hash = (hash ^ bytes[index]) * s_HashPrime;
+            }
+        }
+
+        template<typename T>
+        static void hashArgument(uint64_t& hash, const T& value) {
+            using Value = std::remove_cv_t<T>;
+
+            if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+                if constexpr (std::is_pointer_v<Value>) {
+                    if (!value) {
+                        hashBytes(hash, &value, sizeof(value));
+                        return;
+                    }
+                }
+
+                // The length keeps ("ab", "c") apart from ("a", "bc")
+                const std::string_view text(value);
+                const size_t size = text.size();
+                hashBytes(hash, text.data(), size);
+                hashBytes(hash, &size, sizeof(size));
+            }
+            else if constexpr (std::is_trivially_copyable_v<Value>) {
+                // Numbers, pointers and math types. Differing padding only costs a missed duplicate.
+                hashBytes(hash, &value, sizeof(Value));
+            }
+            else {
+                // No generic way to compare other types than their text, they are rare in log messages
+                hashArgument(hash, fmt::format("{}", value));
+            }
+        }
+
+        static int64_t getMilliseconds() {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        static void registerSite(LogSite& site);
+
+        static uint32_t s_MessagesPerSecond;
+        static bool s_SuppressDuplicates;
+    };
+}
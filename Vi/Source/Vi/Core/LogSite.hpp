@@ -0,0 +1,24 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace Vi {
+    // One per log macro call site, created on its first use and never destroyed
+    struct LogSite {
+        const char* File;
+        uint32_t Line;
+
+        // Id of the format record in the binary log
+        std::atomic<uint32_t> Id{ 0 };
+
+        // LogLimiter state: messages in the current one second window, the last message and what was held back
+        std::atomic<int64_t> Window{ -1 };
+        std::atomic<uint32_t> WindowCount{ 0 };
+        std::atomic<uint64_t> LastHash{ 0 };
+        std::atomic<int64_t> LastTime{ 0 };
+        std::atomic<uint32_t> Suppressed{ 0 };
+        std::atomic<bool> Registered{ false };
+        LogSite* Next{ nullptr };
+    };
+}
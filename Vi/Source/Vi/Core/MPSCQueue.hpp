@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+
+namespace Vi {
+    // Bounded lock-free queue with any number of producers and a single consumer.
+    // Every cell carries a sequence number telling whether it is free for the producer or ready for the consumer.
+    template<typename T, std::size_t Capacity>
+    class MPSCQueue {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity has to be a power of two!");
+
+    public:
+        MPSCQueue(): m_Cells(std::make_unique<Cell[]>(Capacity)) {
+            for (std::size_t i = 0; i < Capacity; i++) {
+                m_Cells[i].Sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MPSCQueue(const MPSCQueue&) = delete;
+        MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+        // Moves from value only on success, returns false when the queue is full
+        bool tryPush(T& value) {
+            Cell* cell{ nullptr };
+            std::size_t position = m_EnqueuePosition.load(std::memory_order_relaxed);
+
+            for (;;) {
+                cell = &m_Cells[position & (Capacity - 1)];
+                const std::size_t sequence = cell->Sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+                if (difference == 0) {
+                    if (m_EnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                else if (difference < 0) {
+                    return false;
+                }
+                else {
+                    position = m_EnqueuePosition.load(std::memory_order_relaxed);
+                }
+            }
+
+            cell->Data = std::move(value);
+            cell->Sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Must only be called from the consumer thread
+        bool tryPop(T& value) {
+            Cell& cell = m_Cells[m_DequeuePosition & (Capacity - 1)];
+            if (cell.Sequence.load(std::memory_order_acquire) != m_DequeuePosition + 1) {
+                return false;
+            }
+
+            value = std::move(cell.Data);
+            cell.Data = T{};
+            cell.Sequence.store(m_DequeuePosition + Capacity, std::memory_order_release);
+            m_DequeuePosition++;
+            return true;
+        }
+
+    private:
+        static constexpr std::size_t s_CacheLineSize{ 64 };
+
+        struct Cell {
+            std::atomic<std::size_t> Sequence;
+            T Data;
+        };
+
+        std::unique_ptr<Cell[]> m_Cells;
+        alignas(s_CacheLineSize) std::atomic<std::size_t> m_EnqueuePosition{ 0 };
+        alignas(s_CacheLineSize) std::size_t m_DequeuePosition{ 0 };
+    };
+}
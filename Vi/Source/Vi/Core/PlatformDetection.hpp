@@ -6,4 +6,6 @@
     #else
         #error "x86 Builds are not supported!"
     #endif
+#elif defined(__linux__)
+    #define VI_PLATFORM_LINUX
 #endif
@@ -21,6 +21,19 @@ namespace Vi {
             return elapsed() * 1000.0f;
         }
 
+        // Double precision variant for timelines that run for hours
+        double elapsedSeconds() const {
+            return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - m_Start).count();
+        }
+
+        // Returns seconds since the last reset and restarts the timer from the same instant
+        double lap() {
+            const auto now = std::chrono::high_resolution_clock::now();
+            const double seconds = std::chrono::duration<double>(now - m_Start).count();
+            m_Start = now;
+            return seconds;
+        }
+
     private:
         std::chrono::time_point<std::chrono::high_resolution_clock> m_Start;
     };
@@ -4,14 +4,19 @@
 #ifdef VI_PLATFORM_WINDOWS
 #include "Platform/Windows/WindowsWindow.hpp"
 #endif
+#include "Platform/Null/NullWindow.hpp"
 
 namespace Vi {
 	Scope<Window> Window::create(const WindowProperties& props) {
 #ifdef VI_PLATFORM_WINDOWS
-		return CreateScope<WindowsWindow>(props);
+		return createScope<WindowsWindow>(props);
 #else
 		VI_CORE_ASSERT(false, "Unknown platform!");
 		return nullptr;
 #endif
 	}
+
+	Scope<Window> Window::createHeadless(const WindowProperties& props) {
+		return createScope<NullWindow>(props);
+	}
 }
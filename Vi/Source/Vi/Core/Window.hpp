@@ -21,7 +21,16 @@ namespace Vi {
         using EventCallbackFn = std::function<void(Event&)>;
         virtual ~Window() = default;
 
+        // Polls events and swaps buffers, pipelined frames call the two halves separately
         virtual void onUpdate() = 0;
+        virtual void pollEvents() = 0;
+        virtual void swapBuffers() = 0;
+        // Blocks until an event arrives or timeout seconds pass, events are dispatched like in pollEvents
+        virtual void waitEvents(double timeout) = 0;
+
+        // Binds or releases the graphics context for the calling thread
+        virtual void makeContextCurrent(bool current) = 0;
+
         virtual uint32_t getWidth() const = 0;
         virtual uint32_t getHeight() const = 0;
 
@@ -33,5 +42,6 @@ namespace Vi {
         virtual void* getNativeWindow() const = 0;
 
         static Scope<Window> create(const WindowProperties& props = WindowProperties());
+        static Scope<Window> createHeadless(const WindowProperties& props = WindowProperties());
     };
 }
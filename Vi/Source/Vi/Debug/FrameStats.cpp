@@ -0,0 +1,298 @@
+#include "vipch.hpp"
+#include "Vi/Debug/FrameStats.hpp"
+#include "Vi/Core/Layer.hpp"
+
+#include <cmath>
+#include <fstream>
+
+namespace Vi {
+	namespace {
+		constexpr size_t s_TimingCount{ static_cast<size_t>(LayerTiming::Count) };
+
+		constexpr std::array<LayerPhaseFlags, s_TimingCount> s_TimingPhases{
+			LayerPhase::Update,
+			LayerPhase::FixedUpdate,
+			LayerPhase::Render | LayerPhase::BuildRenderPacket,
+			LayerPhase::ImGuiRender,
+			LayerPhase::Event
+		};
+
+		uint32_t getTimings(const Layer& layer) {
+			uint32_t timings{ 0 };
+			for (size_t index = 0; index < s_TimingCount; index++) {
+				if (layer.getPhases() & s_TimingPhases[index]) {
+					timings |= BIT(index);
+				}
+			}
+			return timings;
+		}
+
+		float toMilliseconds(FrameStats::Clock::duration duration) {
+			return std::chrono::duration<float, std::milli>(duration).count();
+		}
+
+		// Nearest rank on a sorted window
+		float getPercentile(const std::vector<float>& sorted, float percentile) {
+			const auto rank = static_cast<size_t>(std::ceil(percentile * static_cast<float>(sorted.size())));
+			return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+		}
+
+		void writeJsonString(std::ostream& output, const std::string& value) {
+			output << '"';
+			for (const char c : value) {
+				if (c == '"' || c == '\\') {
+					output << '\\';
+				}
+				output << c;
+			}
+			output << '"';
+		}
+
+		void writeJsonSummary(std::ostream& output, const FrameTimeSummary& summary) {
+			output << fmt::format("{{\"samples\":{},\"mean\":{:.4f},\"p50\":{:.4f},\"p95\":{:.4f},\"p99\":{:.4f},\"max\":{:.4f}}}",
+				summary.SampleCount, summary.Mean, summary.P50, summary.P95, summary.P99, summary.Max);
+		}
+
+		void writeCsvRow(std::ostream& output, const std::string& name, const char* timing, const FrameTimeSummary& summary) {
+			// Layer names are free text, quote them and double embedded quotes
+			std::string quoted;
+			for (const char c : name) {
+				quoted.append(c == '"' ? "\"\"" : std::string(1, c));
+			}
+
+			output << fmt::format("\"{}\",{},{},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f}\n",
+				quoted, timing, summary.SampleCount, summary.Mean, summary.P50, summary.P95, summary.P99, summary.Max);
+		}
+	}
+
+	const char* getLayerTimingName(LayerTiming timing) {
+		switch (timing) {
+		case LayerTiming::Update:
+			return "Update";
+		case LayerTiming::FixedUpdate:
+			return "FixedUpdate";
+		case LayerTiming::Render:
+			return "Render";
+		case LayerTiming::ImGuiRender:
+			return "ImGuiRender";
+		case LayerTiming::Event:
+			return "Event";
+		case LayerTiming::Count:
+			break;
+		}
+
+		VI_CORE_ASSERT(false, "Unknown layer timing!");
+		return "Unknown";
+	}
+
+	FrameTimeHistogram::FrameTimeHistogram(uint32_t capacity) {
+		setCapacity(capacity);
+	}
+
+	void FrameTimeHistogram::setCapacity(uint32_t capacity) {
+		m_Samples.assign(std::max(capacity, 1u), 0.0f);
+		m_Next = 0;
+		m_Count = 0;
+	}
+
+	void FrameTimeHistogram::add(float value) {
+		m_Samples[m_Next] = value;
+		m_Next = (m_Next + 1) % getCapacity();
+		m_Count = std::min(m_Count + 1, getCapacity());
+	}
+
+	void FrameTimeHistogram::clear() {
+		m_Next = 0;
+		m_Count = 0;
+	}
+
+	FrameTimeSummary FrameTimeHistogram::summarize() const {
+		FrameTimeSummary summary;
+		if (m_Count == 0) {
+			return summary;
+		}
+
+		copySamples(m_Scratch);
+		std::sort(m_Scratch.begin(), m_Scratch.end());
+
+		double sum{ 0.0 };
+		for (const float sample : m_Scratch) {
+			sum += sample;
+		}
+
+		summary.SampleCount = m_Count;
+		summary.Mean = static_cast<float>(sum / m_Count);
+		summary.P50 = getPercentile(m_Scratch, 0.50f);
+		summary.P95 = getPercentile(m_Scratch, 0.95f);
+		summary.P99 = getPercentile(m_Scratch, 0.99f);
+		summary.Max = m_Scratch.back();
+		return summary;
+	}
+
+	void FrameTimeHistogram::copySamples(std::vector<float>& samples) const {
+		samples.resize(m_Count);
+
+		const uint32_t first = (m_Next + getCapacity() - m_Count) % getCapacity();
+		for (uint32_t index = 0; index < m_Count; index++) {
+			samples[index] = m_Samples[(first + index) % getCapacity()];
+		}
+	}
+
+	FrameStats::FrameStats(uint32_t windowSize): m_WindowSize(std::max(windowSize, 1u)), m_FrameTime(m_WindowSize), m_WorkTime(m_WindowSize) {}
+
+	void FrameStats::setWindowSize(uint32_t frames) {
+		m_WindowSize = std::max(frames, 1u);
+		m_FrameTime.setCapacity(m_WindowSize);
+		m_WorkTime.setCapacity(m_WindowSize);
+
+		for (auto& [layer, entry] : m_Layers) {
+			for (auto& history : entry.History) {
+				history.setCapacity(m_WindowSize);
+			}
+		}
+	}
+
+	void FrameStats::syncLayers(const std::vector<Layer*>& layers) {
+		VI_PROFILE_FUNCTION();
+		VI_MEMORY_TAG(Debug);
+
+		std::unordered_map<const Layer*, LayerEntry> previous;
+		std::swap(previous, m_Layers);
+		m_LayerOrder.clear();
+
+		for (const auto* layer : layers) {
+			// A new layer allocated where a popped one used to live is not the same layer
+			auto it = previous.find(layer);
+			if (it != previous.end() && it->second.Name == layer->getName() && it->second.Timings == getTimings(*layer)) {
+				m_Layers.emplace(layer, std::move(it->second));
+			}
+			else {
+				auto& entry = m_Layers[layer];
+				entry.Name = layer->getName();
+				entry.Timings = getTimings(*layer);
+				for (auto& history : entry.History) {
+					history.setCapacity(m_WindowSize);
+				}
+			}
+			m_LayerOrder.push_back(layer);
+		}
+	}
+
+	void FrameStats::beginFrame() {
+		m_FrameStart = Clock::now();
+	}
+
+	void FrameStats::endFrame(float frameSeconds) {
+		if (!m_Enabled) {
+			return;
+		}
+
+		m_FrameTime.add(frameSeconds * 1000.0f);
+		m_WorkTime.add(toMilliseconds(Clock::now() - m_FrameStart));
+		m_FrameCount++;
+
+		for (auto& [layer, entry] : m_Layers) {
+			for (size_t index = 0; index < s_TimingCount; index++) {
+				if (entry.Ran[index]) {
+					entry.History[index].add(toMilliseconds(entry.Accumulated[index]));
+				}
+				entry.Accumulated[index] = {};
+				entry.Ran[index] = false;
+			}
+		}
+	}
+
+	void FrameStats::discardFrame() {
+		for (auto& [layer, entry] : m_Layers) {
+			entry.Accumulated.fill({});
+			entry.Ran.fill(false);
+		}
+	}
+
+	void FrameStats::addLayerTime(const Layer* layer, LayerTiming timing, Clock::duration duration) {
+		const auto it = m_Layers.find(layer);
+		if (it != m_Layers.end()) {
+			it->second.Accumulated[static_cast<size_t>(timing)] += duration;
+			it->second.Ran[static_cast<size_t>(timing)] = true;
+		}
+	}
+
+	std::vector<LayerFrameStats> FrameStats::getLayerStats() const {
+		std::vector<LayerFrameStats> stats;
+		stats.reserve(m_LayerOrder.size());
+
+		for (const auto* layer : m_LayerOrder) {
+			const auto& entry = m_Layers.at(layer);
+
+			auto& layerStats = stats.emplace_back();
+			layerStats.Name = entry.Name;
+			for (size_t index = 0; index < s_TimingCount; index++) {
+				layerStats.Timings[index] = entry.History[index].summarize();
+			}
+		}
+
+		return stats;
+	}
+
+	bool FrameStats::exportCsv(const std::filesystem::path& filepath) const {
+		std::ofstream output(filepath);
+		if (!output) {
+			VI_CORE_ERROR("Could not write frame stats to '{0}'", filepath.string());
+			return false;
+		}
+
+		output << "Name,Timing,Samples,Mean,P50,P95,P99,Max\n";
+		writeCsvRow(output, "Frame", "Interval", getFrameTime());
+		writeCsvRow(output, "Frame", "Work", getWorkTime());
+
+		for (const auto& layer : getLayerStats()) {
+			for (size_t index = 0; index < s_TimingCount; index++) {
+				if (layer.Timings[index].SampleCount > 0) {
+					writeCsvRow(output, layer.Name, getLayerTimingName(static_cast<LayerTiming>(index)), layer.Timings[index]);
+				}
+			}
+		}
+
+		return true;
+	}
+
+	bool FrameStats::exportJson(const std::filesystem::path& filepath) const {
+		std::ofstream output(filepath);
+		if (!output) {
+			VI_CORE_ERROR("Could not write frame stats to '{0}'", filepath.string());
+			return false;
+		}
+
+		output << "{\"frames\":" << m_FrameCount << ",\"interval\":";
+		writeJsonSummary(output, getFrameTime());
+		output << ",\"work\":";
+		writeJsonSummary(output, getWorkTime());
+
+		// Raw interval window so plots can be redrawn offline
+		std::vector<float> samples;
+		m_FrameTime.copySamples(samples);
+		output << ",\"intervalSamples\":[";
+		for (size_t index = 0; index < samples.size(); index++) {
+			output << (index ? "," : "") << fmt::format("{:.4f}", samples[index]);
+		}
+
+		output << "],\"layers\":[";
+		bool firstLayer = true;
+		for (const auto& layer : getLayerStats()) {
+			output << (firstLayer ? "\n{\"name\":" : ",\n{\"name\":");
+			firstLayer = false;
+			writeJsonString(output, layer.Name);
+
+			for (size_t index = 0; index < s_TimingCount; index++) {
+				if (layer.Timings[index].SampleCount > 0) {
+					output << ",\"" << getLayerTimingName(static_cast<LayerTiming>(index)) << "\":";
+					writeJsonSummary(output, layer.Timings[index]);
+				}
+			}
+			output << "}";
+		}
+		output << "\n]}\n";
+
+		return true;
+	}
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "Vi/Core/Base.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Vi {
+    class Layer;
+
+    // Layer callbacks timed by FrameStats, onBuildRenderPacket counts as Render
+    enum class LayerTiming : uint8_t {
+        Update,
+        FixedUpdate,
+        Render,
+        ImGuiRender,
+        Event,
+
+        Count
+    };
+
+    [[nodiscard]] const char* getLayerTimingName(LayerTiming timing);
+
+    // All durations are in milliseconds
+    struct FrameTimeSummary {
+        uint32_t SampleCount{ 0 };
+        float Mean{ 0.0f };
+        float P50{ 0.0f };
+        float P95{ 0.0f };
+        float P99{ 0.0f };
+        float Max{ 0.0f };
+    };
+
+    // Keeps the most recent samples, summaries are computed over the whole window
+    class FrameTimeHistogram {
+    public:
+        explicit FrameTimeHistogram(uint32_t capacity = 300);
+
+        // Drops all samples
+        void setCapacity(uint32_t capacity);
+
+        void add(float value);
+        void clear();
+
+        [[nodiscard]] FrameTimeSummary summarize() const;
+
+        // Oldest first
+        void copySamples(std::vector<float>& samples) const;
+
+        [[nodiscard]] uint32_t getCapacity() const {
+            return static_cast<uint32_t>(m_Samples.size());
+        }
+
+        [[nodiscard]] uint32_t getCount() const {
+            return m_Count;
+        }
+
+    private:
+        std::vector<float> m_Samples;
+        uint32_t m_Next{ 0 };
+        uint32_t m_Count{ 0 };
+        mutable std::vector<float> m_Scratch;
+    };
+
+    struct LayerFrameStats {
+        std::string Name;
+        // Indexed by LayerTiming, callbacks the layer did not register for have no samples
+        std::array<FrameTimeSummary, static_cast<size_t>(LayerTiming::Count)> Timings;
+    };
+
+    // Rolling frame time and per-layer callback statistics. Frame boundaries and layer syncing happen on the main thread,
+    // layer times may be added from any thread as long as no two threads time the same layer and callback at once.
+    class FrameStats {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // Times a layer callback for the lifetime of the scope, does nothing while stats are disabled
+        class LayerTimer {
+        public:
+            LayerTimer(FrameStats& stats, const Layer* layer, LayerTiming timing): m_Stats(stats.isEnabled() ? &stats : nullptr), m_Layer(layer), m_Timing(timing) {
+                if (m_Stats) {
+                    m_Start = Clock::now();
+                }
+            }
+
+            ~LayerTimer() {
+                if (m_Stats) {
+                    m_Stats->addLayerTime(m_Layer, m_Timing, Clock::now() - m_Start);
+                }
+            }
+
+            LayerTimer(const LayerTimer&) = delete;
+            LayerTimer& operator=(const LayerTimer&) = delete;
+
+        private:
+            FrameStats* m_Stats;
+            const Layer* m_Layer;
+            LayerTiming m_Timing;
+            Clock::time_point m_Start;
+        };
+
+        explicit FrameStats(uint32_t windowSize = 300);
+
+        FrameStats(const FrameStats&) = delete;
+        FrameStats& operator=(const FrameStats&) = delete;
+
+        void setEnabled(bool enabled) {
+            m_Enabled = enabled;
+        }
+
+        [[nodiscard]] bool isEnabled() const {
+            return m_Enabled;
+        }
+
+        // Number of frames the summaries cover, clears all samples
+        void setWindowSize(uint32_t frames);
+
+        // Matches the tracked layers to the stack, has to be called whenever the stack changed
+        void syncLayers(const std::vector<Layer*>& layers);
+
+        void beginFrame();
+        // Frame interval as seen by the application, the work time is measured from beginFrame
+        void endFrame(float frameSeconds);
+        // Throws away layer times collected since beginFrame, for frames that should not count
+        void discardFrame();
+
+        void addLayerTime(const Layer* layer, LayerTiming timing, Clock::duration duration);
+
+        [[nodiscard]] FrameTimeSummary getFrameTime() const {
+            return m_FrameTime.summarize();
+        }
+
+        // Time between beginFrame and endFrame, excludes waiting for the frame pacer
+        [[nodiscard]] FrameTimeSummary getWorkTime() const {
+            return m_WorkTime.summarize();
+        }
+
+        [[nodiscard]] const FrameTimeHistogram& getFrameTimeHistogram() const {
+            return m_FrameTime;
+        }
+
+        // In stack order, overlays last
+        [[nodiscard]] std::vector<LayerFrameStats> getLayerStats() const;
+
+        [[nodiscard]] uint64_t getFrameCount() const {
+            return m_FrameCount;
+        }
+
+        bool exportCsv(const std::filesystem::path& filepath) const;
+        bool exportJson(const std::filesystem::path& filepath) const;
+
+    private:
+        struct LayerEntry {
+            std::string Name;
+            uint32_t Timings{ 0 };
+            // Written by whichever thread runs the callback, read at endFrame
+            std::array<Clock::duration, static_cast<size_t>(LayerTiming::Count)> Accumulated{};
+            // Callbacks that did not run this frame, e.g. FixedUpdate on a short frame, add no sample
+            std::array<bool, static_cast<size_t>(LayerTiming::Count)> Ran{};
+            std::array<FrameTimeHistogram, static_cast<size_t>(LayerTiming::Count)> History;
+        };
+
+        bool m_Enabled{ true };
+        uint32_t m_WindowSize;
+        uint64_t m_FrameCount{ 0 };
+        Clock::time_point m_FrameStart;
+
+        FrameTimeHistogram m_FrameTime;
+        FrameTimeHistogram m_WorkTime;
+
+        // Only modified by syncLayers, lookups from other threads never race with it
+        std::unordered_map<const Layer*, LayerEntry> m_Layers;
+        std::vector<const Layer*> m_LayerOrder;
+    };
+}
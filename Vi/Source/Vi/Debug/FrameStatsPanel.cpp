@@ -0,0 +1,124 @@
+#include "vipch.hpp"
+#include "Vi/Debug/FrameStatsPanel.hpp"
+
+#include <imgui.h>
+
+namespace Vi {
+	namespace {
+		void summaryRow(const char* name, const FrameTimeSummary& summary) {
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(name);
+			for (const float value : { summary.Mean, summary.P50, summary.P95, summary.P99, summary.Max }) {
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", value);
+			}
+		}
+
+		bool beginSummaryTable(const char* id) {
+			if (!ImGui::BeginTable(id, 6, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingStretchProp)) {
+				return false;
+			}
+
+			ImGui::TableSetupColumn("ms");
+			for (const char* column : { "Mean", "P50", "P95", "P99", "Max" }) {
+				ImGui::TableSetupColumn(column);
+			}
+			ImGui::TableHeadersRow();
+			return true;
+		}
+	}
+
+	FrameStatsPanel::FrameStatsPanel(FrameStats& stats): Layer("FrameStatsPanel", LayerPhase::ImGuiRender), m_Stats(stats) {}
+
+	void FrameStatsPanel::onImGuiRender() {
+		if (!m_Open) {
+			return;
+		}
+
+		if (!ImGui::Begin("Frame Stats", &m_Open)) {
+			ImGui::End();
+			return;
+		}
+
+		if (!m_Stats.isEnabled()) {
+			ImGui::TextUnformatted("Frame stats are disabled");
+			ImGui::End();
+			return;
+		}
+
+		const auto frameTime = m_Stats.getFrameTime();
+		ImGui::Text("%.1f FPS over the last %u frames", frameTime.Mean > 0.0f ? 1000.0f / frameTime.Mean : 0.0f, frameTime.SampleCount);
+
+		m_Stats.getFrameTimeHistogram().copySamples(m_Samples);
+		ImGui::PlotLines("##FrameTimes", m_Samples.data(), static_cast<int>(m_Samples.size()), 0, nullptr, 0.0f, frameTime.P99 * 1.5f, ImVec2(-1.0f, 60.0f));
+
+		if (beginSummaryTable("Frame")) {
+			summaryRow("Interval", frameTime);
+			summaryRow("Work", m_Stats.getWorkTime());
+			ImGui::EndTable();
+		}
+
+		ImGui::Separator();
+
+		if (ImGui::BeginCombo("Callback", getLayerTimingName(m_Timing))) {
+			for (size_t index = 0; index < static_cast<size_t>(LayerTiming::Count); index++) {
+				const auto timing = static_cast<LayerTiming>(index);
+				if (ImGui::Selectable(getLayerTimingName(timing), timing == m_Timing)) {
+					m_Timing = timing;
+				}
+			}
+			ImGui::EndCombo();
+		}
+
+		if (beginSummaryTable("Layers")) {
+			for (const auto& layer : m_Stats.getLayerStats()) {
+				const auto& summary = layer.Timings[static_cast<size_t>(m_Timing)];
+				if (summary.SampleCount > 0) {
+					summaryRow(layer.Name.c_str(), summary);
+				}
+			}
+			ImGui::EndTable();
+		}
+
+		if (MemoryTracker::isEnabled() && ImGui::CollapsingHeader("Memory")) {
+			const auto total = MemoryTracker::getTotalStats();
+			const auto frame = MemoryTracker::getLastFrameStats();
+			ImGui::Text("%.2f MB live, %.2f MB peak", total.LiveBytes / (1024.0 * 1024.0), total.PeakBytes / (1024.0 * 1024.0));
+			ImGui::Text("%llu allocations (%.1f KB) last frame", static_cast<unsigned long long>(frame.Allocations), frame.Bytes / 1024.0);
+
+			if (ImGui::BeginTable("Memory", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingStretchProp)) {
+				for (const char* column : { "Tag", "Live KB", "Peak KB", "Allocations" }) {
+					ImGui::TableSetupColumn(column);
+				}
+				ImGui::TableHeadersRow();
+
+				for (size_t index = 0; index < static_cast<size_t>(MemoryTag::Count); index++) {
+					const auto tag = static_cast<MemoryTag>(index);
+					const auto stats = MemoryTracker::getStats(tag);
+
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(getMemoryTagName(tag));
+					ImGui::TableNextColumn();
+					ImGui::Text("%.1f", stats.LiveBytes / 1024.0);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.1f", stats.PeakBytes / 1024.0);
+					ImGui::TableNextColumn();
+					ImGui::Text("%llu", static_cast<unsigned long long>(stats.LiveAllocations));
+				}
+				ImGui::EndTable();
+			}
+		}
+
+		if (ImGui::Button("Export CSV")) {
+			m_Stats.exportCsv("ViFrameStats.csv");
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Export JSON")) {
+			m_Stats.exportJson("ViFrameStats.json");
+		}
+
+		ImGui::End();
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Vi/Core/Layer.hpp"
+#include "Vi/Debug/FrameStats.hpp"
+
+namespace Vi {
+    // ImGui overlay showing frame time percentiles and the cost of every layer callback
+    class FrameStatsPanel: public Layer {
+    public:
+        explicit FrameStatsPanel(FrameStats& stats);
+
+        void onImGuiRender() override;
+
+    private:
+        FrameStats& m_Stats;
+        LayerTiming m_Timing{ LayerTiming::Update };
+        bool m_Open{ true };
+        std::vector<float> m_Samples;
+    };
+}
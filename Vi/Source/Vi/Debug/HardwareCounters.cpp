@@ -0,0 +1,145 @@
+#include "vipch.hpp"
+#include "Vi/Debug/HardwareCounters.hpp"
+
+#ifdef VI_PLATFORM_LINUX
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Vi {
+	std::atomic<bool> HardwareCounters::s_Enabled{ false };
+
+#ifdef VI_PLATFORM_LINUX
+	namespace {
+		constexpr std::array<uint64_t, 4> s_Events{
+			PERF_COUNT_HW_CPU_CYCLES,
+			PERF_COUNT_HW_INSTRUCTIONS,
+			PERF_COUNT_HW_CACHE_MISSES,
+			PERF_COUNT_HW_BRANCH_MISSES
+		};
+
+		// Layout of a read on the group leader with PERF_FORMAT_GROUP and both total times
+		struct GroupReadFormat {
+			uint64_t Count;
+			uint64_t TimeEnabled;
+			uint64_t TimeRunning;
+			uint64_t Values[s_Events.size()];
+		};
+
+		// All counters of a thread form one group so they are scheduled onto the PMU together
+		class CounterGroup {
+		public:
+			~CounterGroup() {
+				close();
+			}
+
+			bool open() {
+				for (size_t index = 0; index < s_Events.size(); index++) {
+					perf_event_attr attributes{};
+					attributes.size = sizeof(attributes);
+					attributes.type = PERF_TYPE_HARDWARE;
+					attributes.config = s_Events[index];
+					attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+					attributes.exclude_kernel = 1;
+					attributes.exclude_hv = 1;
+
+					const int leader = index == 0 ? -1 : m_Descriptors[0];
+					m_Descriptors[index] = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, leader, PERF_FLAG_FD_CLOEXEC));
+					if (m_Descriptors[index] < 0) {
+						m_Error = errno;
+						close();
+						return false;
+					}
+				}
+
+				return true;
+			}
+
+			bool read(HardwareCounterValues& values) const {
+				GroupReadFormat data;
+				if (::read(m_Descriptors[0], &data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data.Count != s_Events.size()) {
+					return false;
+				}
+
+				values = { data.Values[0], data.Values[1], data.Values[2], data.Values[3], data.TimeEnabled, data.TimeRunning };
+				return true;
+			}
+
+			[[nodiscard]] bool isOpen() const {
+				return m_Descriptors[0] >= 0;
+			}
+
+			[[nodiscard]] int getError() const {
+				return m_Error;
+			}
+
+		private:
+			void close() {
+				for (auto& descriptor : m_Descriptors) {
+					if (descriptor >= 0) {
+						::close(descriptor);
+						descriptor = -1;
+					}
+				}
+			}
+
+			std::array<int, s_Events.size()> m_Descriptors{ -1, -1, -1, -1 };
+			int m_Error{ 0 };
+		};
+
+		struct ThreadCounters {
+			CounterGroup Group;
+			bool Attempted{ false };
+		};
+
+		thread_local ThreadCounters s_ThreadCounters;
+
+		CounterGroup* getThreadGroup() {
+			auto& counters = s_ThreadCounters;
+			if (!counters.Attempted) {
+				counters.Attempted = true;
+				counters.Group.open();
+			}
+
+			return counters.Group.isOpen() ? &counters.Group : nullptr;
+		}
+	}
+
+	bool HardwareCounters::setEnabled(bool enabled) {
+		if (!enabled) {
+			s_Enabled.store(false, std::memory_order_relaxed);
+			return true;
+		}
+
+		// Probe on the calling thread. Failures are usually a perf_event_paranoid setting or a virtual machine without a PMU.
+		if (!getThreadGroup()) {
+			VI_CORE_WARN("Hardware counters are unavailable: {0}. Check /proc/sys/kernel/perf_event_paranoid and that the CPU exposes a PMU", std::strerror(s_ThreadCounters.Group.getError()));
+			return false;
+		}
+
+		s_Enabled.store(true, std::memory_order_relaxed);
+		VI_CORE_INFO("Hardware counters enabled for profile scopes");
+		return true;
+	}
+
+	bool HardwareCounters::read(HardwareCounterValues& values) {
+		const auto* group = getThreadGroup();
+		return group && group->read(values);
+	}
+#else
+	bool HardwareCounters::setEnabled(bool enabled) {
+		if (enabled) {
+			VI_CORE_WARN("Hardware counters are only supported on Linux");
+		}
+		return !enabled;
+	}
+
+	bool HardwareCounters::read(HardwareCounterValues& values) {
+		return false;
+	}
+#endif
+}
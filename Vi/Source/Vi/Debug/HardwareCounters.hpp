@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+
+namespace Vi {
+    struct HardwareCounterValues {
+        uint64_t Cycles{ 0 };
+        uint64_t Instructions{ 0 };
+        uint64_t CacheMisses{ 0 };
+        uint64_t BranchMisses{ 0 };
+        // Nanoseconds the counters were enabled and actually counting, they only differ when the PMU was shared
+        uint64_t TimeEnabled{ 0 };
+        uint64_t TimeRunning{ 0 };
+
+        HardwareCounterValues operator-(const HardwareCounterValues& other) const {
+            return {
+                Cycles - other.Cycles, Instructions - other.Instructions, CacheMisses - other.CacheMisses, BranchMisses - other.BranchMisses,
+                TimeEnabled - other.TimeEnabled, TimeRunning - other.TimeRunning
+            };
+        }
+
+        // Extrapolates counts of an interval in which the counters were multiplexed with other events, like perf stat does.
+        // Returns false if they never ran during it, the counts mean nothing then.
+        bool scaleToEnabledTime() {
+            if (TimeRunning == 0) {
+                return false;
+            }
+
+            if (TimeRunning < TimeEnabled) {
+                const double scale = static_cast<double>(TimeEnabled) / static_cast<double>(TimeRunning);
+                for (uint64_t* value : { &Cycles, &Instructions, &CacheMisses, &BranchMisses }) {
+                    *value = static_cast<uint64_t>(static_cast<double>(*value) * scale);
+                }
+                TimeRunning = TimeEnabled;
+            }
+            return true;
+        }
+    };
+
+    // CPU performance counters of the calling thread, counted in user space only. Backed by perf_event_open on Linux
+    // and unavailable elsewhere. Every read is a syscall, so enabling them adds roughly a microsecond to each profile scope.
+    class HardwareCounters {
+    public:
+        // Returns whether the counters could be opened, they stay disabled otherwise
+        static bool setEnabled(bool enabled);
+
+        [[nodiscard]] static bool isEnabled() {
+            return s_Enabled.load(std::memory_order_relaxed);
+        }
+
+        // Opens the counters for the calling thread on first use, returns false if they are not available on it
+        static bool read(HardwareCounterValues& values);
+
+    private:
+        static std::atomic<bool> s_Enabled;
+    };
+}
@@ -0,0 +1,565 @@
+#include "vipch.hpp"
+#include "Vi/Debug/Instrumentor.hpp"
+
+#include <condition_variable>
+#include <csignal>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace Vi {
+	std::atomic<bool> Instrumentor::s_Active{ false };
+
+	namespace {
+		constexpr uint32_t s_ThreadBufferCapacity{ 16384 };
+		constexpr size_t s_OutputFlushSize{ 1 << 16 };
+		constexpr auto s_WriterInterval{ std::chrono::milliseconds(10) };
+
+		enum class ProfileEventKind : uint8_t {
+			Scope,
+			// Scope with hardware counters stored at the same index in the counter ring
+			ScopeWithCounters,
+			// Start is the timestamp and End the value
+			Counter
+		};
+
+		struct ProfileEvent {
+			const char* Name;
+			uint64_t Start;
+			uint64_t End;
+			ProfileEventKind Kind;
+		};
+
+		// Single producer ring written by its thread and drained by the writer thread
+		struct ThreadBuffer {
+			uint32_t ThreadId{ 0 };
+			// Guarded by s_BuffersMutex
+			std::string Name;
+			bool Free{ false };
+
+			alignas(64) std::atomic<uint32_t> Head{ 0 };
+			alignas(64) std::atomic<uint32_t> Tail{ 0 };
+			// Producer side copy of Head, only reloaded when the ring looks full
+			uint32_t CachedHead{ 0 };
+			ProfileEvent Events[s_ThreadBufferCapacity];
+			// Only allocated once the thread records hardware counters, published along with the first event using it
+			Scope<HardwareCounterValues[]> Counters;
+
+			// Flight recorder history, overwritten oldest first and only touched by the writer thread
+			std::vector<ProfileEvent> History;
+			std::vector<HardwareCounterValues> HistoryCounters;
+			size_t HistoryNext{ 0 };
+			size_t HistoryCount{ 0 };
+		};
+
+		std::mutex s_BuffersMutex;
+		std::vector<Scope<ThreadBuffer>> s_Buffers;
+		std::atomic<uint64_t> s_DroppedScopes{ 0 };
+
+		// Hands the buffer to a new thread once this one exited and everything it recorded was drained
+		struct ThreadBufferOwner {
+			ThreadBuffer* Buffer{ nullptr };
+
+			~ThreadBufferOwner() {
+				if (Buffer) {
+					// The name stays until the buffer is reused, the thread's events may not be written yet
+					std::scoped_lock<std::mutex> lock(s_BuffersMutex);
+					Buffer->Free = true;
+				}
+			}
+		};
+
+		thread_local ThreadBufferOwner s_ThreadBuffer;
+
+		enum class Mode {
+			None,
+			Session,
+			FlightRecorder
+		};
+
+		// Changed by the begin and end functions only, dump requests from any thread read it
+		std::atomic<Mode> s_Mode{ Mode::None };
+
+		// Only touched by the begin and end functions and the writer thread they start and join
+		std::mutex s_SessionMutex;
+		double s_TicksPerMicrosecond{ 0.0 };
+
+		std::ofstream s_Output;
+		std::string s_Json;
+		bool s_FirstEvent{ true };
+		uint64_t s_SessionStart{ 0 };
+
+		FlightRecorderSpecification s_FlightRecorder;
+		std::chrono::steady_clock::time_point s_LastDump;
+		bool s_HasDumped{ false };
+		uint32_t s_DumpCount{ 0 };
+		// Written from signal handlers, so it has to stay a lock-free atomic
+		std::atomic<const char*> s_DumpReason{ nullptr };
+		std::atomic<float> s_HitchThreshold{ 0.0f };
+
+		std::thread s_Writer;
+		std::mutex s_WriterMutex;
+		std::condition_variable s_WriterCondition;
+		bool s_WriterRunning{ false };
+		std::atomic<bool> s_DrainRequested{ false };
+
+		ThreadBuffer& getThreadBuffer() {
+			if (s_ThreadBuffer.Buffer) {
+				return *s_ThreadBuffer.Buffer;
+			}
+
+			VI_MEMORY_TAG(Debug);
+			std::scoped_lock<std::mutex> lock(s_BuffersMutex);
+			// Events the last owner left in the ring would otherwise be written under the new thread
+			auto it = std::find_if(s_Buffers.begin(), s_Buffers.end(), [](const Scope<ThreadBuffer>& buffer) {
+				return buffer->Free && buffer->Head.load(std::memory_order_acquire) == buffer->Tail.load(std::memory_order_relaxed);
+			});
+			if (it == s_Buffers.end()) {
+				it = s_Buffers.insert(s_Buffers.end(), createScope<ThreadBuffer>());
+				(*it)->ThreadId = static_cast<uint32_t>(s_Buffers.size());
+			}
+
+			(*it)->Name.clear();
+			(*it)->Free = false;
+			s_ThreadBuffer.Buffer = it->get();
+			return *s_ThreadBuffer.Buffer;
+		}
+
+		double calibrateTimestamp() {
+#ifdef VI_PROFILE_USE_TSC
+			// The TSC runs at a constant rate on every CPU this engine targets, measure it once against the steady clock
+			static const double ticksPerMicrosecond = []() {
+				const auto clockStart = std::chrono::steady_clock::now();
+				const uint64_t ticksStart = Instrumentor::getTimestamp();
+				std::this_thread::sleep_for(std::chrono::milliseconds(20));
+				const uint64_t ticksEnd = Instrumentor::getTimestamp();
+				const auto clockEnd = std::chrono::steady_clock::now();
+
+				return static_cast<double>(ticksEnd - ticksStart) / std::chrono::duration<double, std::micro>(clockEnd - clockStart).count();
+			}();
+			return ticksPerMicrosecond;
+#else
+			using Period = std::chrono::steady_clock::period;
+			return static_cast<double>(Period::den) / (static_cast<double>(Period::num) * 1e6);
+#endif
+		}
+
+		void appendName(std::string& json, const char* name) {
+			for (const char* c = name; *c; c++) {
+				// MSVC function signatures carry the calling convention, it only adds noise to the trace
+				if (*c == '_' && std::strncmp(c, "__cdecl ", 8) == 0) {
+					c += 7;
+					continue;
+				}
+
+				if (*c == '"' || *c == '\\') {
+					json.push_back('\\');
+				}
+				json.push_back(*c);
+			}
+		}
+
+		void appendEvent(std::string& json, bool& first, const ProfileEvent& event, const HardwareCounterValues* counters, uint32_t threadId, uint64_t origin) {
+			const double start = static_cast<double>(event.Start - origin) / s_TicksPerMicrosecond;
+
+			json.append(first ? "\n{" : ",\n{");
+			first = false;
+
+			if (event.Kind == ProfileEventKind::Counter) {
+				json.append("\"name\":\"");
+				appendName(json, event.Name);
+				fmt::format_to(std::back_inserter(json), "\",\"ph\":\"C\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"args\":{{\"value\":{}}}}}", threadId, start, event.End);
+				return;
+			}
+
+			const double duration = static_cast<double>(event.End - event.Start) / s_TicksPerMicrosecond;
+			fmt::format_to(std::back_inserter(json), "\"cat\":\"function\",\"dur\":{:.3f},\"name\":\"", duration);
+			appendName(json, event.Name);
+			fmt::format_to(std::back_inserter(json), "\",\"ph\":\"X\",\"pid\":0,\"tid\":{},\"ts\":{:.3f}", threadId, start);
+
+			if (counters) {
+				const double ipc = counters->Cycles ? static_cast<double>(counters->Instructions) / static_cast<double>(counters->Cycles) : 0.0;
+				fmt::format_to(std::back_inserter(json), ",\"args\":{{\"cycles\":{},\"instructions\":{},\"ipc\":{:.3f},\"cache_misses\":{},\"branch_misses\":{}}}",
+					counters->Cycles, counters->Instructions, ipc, counters->CacheMisses, counters->BranchMisses);
+			}
+			json.push_back('}');
+		}
+
+		void appendThreadNames(std::string& json, bool& first) {
+			std::scoped_lock<std::mutex> lock(s_BuffersMutex);
+			for (const auto& buffer : s_Buffers) {
+				if (buffer->Name.empty()) {
+					continue;
+				}
+
+				json.append(first ? "\n{" : ",\n{");
+				first = false;
+				fmt::format_to(std::back_inserter(json), "\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":{},\"args\":{{\"name\":\"", buffer->ThreadId);
+				appendName(json, buffer->Name.c_str());
+				json.append("\"}}");
+			}
+		}
+
+		void flushJson() {
+			s_Output.write(s_Json.data(), static_cast<std::streamsize>(s_Json.size()));
+			s_Json.clear();
+		}
+
+		std::vector<ThreadBuffer*> getBuffers() {
+			std::vector<ThreadBuffer*> buffers;
+
+			std::scoped_lock<std::mutex> lock(s_BuffersMutex);
+			for (auto& buffer : s_Buffers) {
+				buffers.push_back(buffer.get());
+			}
+			return buffers;
+		}
+
+		template<typename Function>
+		void drainBuffers(Function&& function) {
+			for (auto* buffer : getBuffers()) {
+				const uint32_t tail = buffer->Tail.load(std::memory_order_acquire);
+				for (uint32_t head = buffer->Head.load(std::memory_order_relaxed); head != tail; head++) {
+					const uint32_t index = head % s_ThreadBufferCapacity;
+					const auto& event = buffer->Events[index];
+					// Scopes that started before the session, or were still being written when the last one ended
+					if (event.Start >= s_SessionStart) {
+						function(*buffer, event, event.Kind == ProfileEventKind::ScopeWithCounters ? &buffer->Counters[index] : nullptr);
+					}
+				}
+				buffer->Head.store(tail, std::memory_order_release);
+			}
+		}
+
+		void drainIntoSession() {
+			drainBuffers([](ThreadBuffer& buffer, const ProfileEvent& event, const HardwareCounterValues* counters) {
+				appendEvent(s_Json, s_FirstEvent, event, counters, buffer.ThreadId, s_SessionStart);
+				if (s_Json.size() >= s_OutputFlushSize) {
+					flushJson();
+				}
+			});
+		}
+
+		void drainIntoHistory() {
+			const size_t capacity = s_FlightRecorder.HistoryCapacity;
+			drainBuffers([capacity](ThreadBuffer& buffer, const ProfileEvent& event, const HardwareCounterValues* counters) {
+				if (buffer.History.size() != capacity) {
+					buffer.History.assign(capacity, {});
+					buffer.HistoryCounters.clear();
+					buffer.HistoryNext = 0;
+					buffer.HistoryCount = 0;
+				}
+
+				if (counters) {
+					if (buffer.HistoryCounters.size() != capacity) {
+						buffer.HistoryCounters.resize(capacity);
+					}
+					buffer.HistoryCounters[buffer.HistoryNext] = *counters;
+				}
+
+				buffer.History[buffer.HistoryNext] = event;
+				buffer.HistoryNext = (buffer.HistoryNext + 1) % capacity;
+				buffer.HistoryCount = std::min(buffer.HistoryCount + 1, capacity);
+			});
+		}
+
+		std::filesystem::path getDumpPath(const char* reason) {
+			const std::time_t now = std::time(nullptr);
+			std::tm local{};
+#ifdef VI_PLATFORM_WINDOWS
+			localtime_s(&local, &now);
+#else
+			localtime_r(&now, &local);
+#endif
+
+			char timestamp[32];
+			std::strftime(timestamp, sizeof(timestamp), "%Y%m%d-%H%M%S", &local);
+
+			// The reason comes from the caller, anything but [A-Za-z0-9_-] could leave the directory or break the name
+			std::string name = reason;
+			for (char& character : name) {
+				const bool safe = (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') || (character >= '0' && character <= '9') || character == '-';
+				if (!safe) {
+					character = '_';
+				}
+			}
+			return std::filesystem::path(s_FlightRecorder.DumpDirectory) / fmt::format("ViFlightRecorder-{}-{}-{}.json", timestamp, name, ++s_DumpCount);
+		}
+
+		void writeDump(const char* reason) {
+			const auto now = std::chrono::steady_clock::now();
+			if (s_HasDumped && std::chrono::duration<float>(now - s_LastDump).count() < s_FlightRecorder.MinDumpInterval) {
+				VI_CORE_INFO("Flight recorder skipped a dump ({0}), the last one was written less than {1}s ago", reason, s_FlightRecorder.MinDumpInterval);
+				return;
+			}
+			s_LastDump = now;
+			s_HasDumped = true;
+
+			drainIntoHistory();
+
+			const auto window = static_cast<uint64_t>(static_cast<double>(s_FlightRecorder.Duration) * 1e6 * s_TicksPerMicrosecond);
+			const uint64_t end = Instrumentor::getTimestamp();
+			const uint64_t origin = end > window ? end - window : 0;
+
+			std::string json = "{\"otherData\": {},\"traceEvents\":[";
+			bool first = true;
+			for (auto* buffer : getBuffers()) {
+				const size_t capacity = buffer->History.size();
+				for (size_t i = 0; i < buffer->HistoryCount; i++) {
+					const size_t index = (buffer->HistoryNext + capacity - buffer->HistoryCount + i) % capacity;
+					const auto& event = buffer->History[index];
+					if (event.Start >= origin) {
+						const auto* counters = event.Kind == ProfileEventKind::ScopeWithCounters ? &buffer->HistoryCounters[index] : nullptr;
+						appendEvent(json, first, event, counters, buffer->ThreadId, origin);
+					}
+				}
+			}
+			appendThreadNames(json, first);
+			json.append("\n]}");
+
+			const auto path = getDumpPath(reason);
+			std::ofstream output(path);
+			if (!output) {
+				VI_CORE_ERROR("Flight recorder could not write '{0}'", path.string());
+				return;
+			}
+
+			output.write(json.data(), static_cast<std::streamsize>(json.size()));
+			VI_CORE_WARN("Flight recorder dumped the last {0}s to '{1}' ({2})", s_FlightRecorder.Duration, path.string(), reason);
+		}
+
+		void writerLoop() {
+			VI_MEMORY_TAG(Debug);
+			std::unique_lock<std::mutex> lock(s_WriterMutex);
+			while (s_WriterRunning) {
+				s_WriterCondition.wait_for(lock, s_WriterInterval, []() {
+					return !s_WriterRunning || s_DrainRequested.exchange(false, std::memory_order_relaxed) || s_DumpReason.load(std::memory_order_relaxed);
+				});
+
+				lock.unlock();
+				if (s_Mode.load(std::memory_order_relaxed) == Mode::Session) {
+					// A dump requested while switching modes is meaningless here, it would keep waking the writer
+					s_DumpReason.store(nullptr, std::memory_order_relaxed);
+					drainIntoSession();
+				}
+				else {
+					drainIntoHistory();
+					if (const char* reason = s_DumpReason.exchange(nullptr, std::memory_order_acq_rel)) {
+						writeDump(reason);
+					}
+				}
+				lock.lock();
+			}
+		}
+
+		void startWriter(Mode mode) {
+			s_Mode.store(mode, std::memory_order_relaxed);
+			s_TicksPerMicrosecond = calibrateTimestamp();
+			s_SessionStart = Instrumentor::getTimestamp();
+
+			s_WriterRunning = true;
+			s_Writer = std::thread(writerLoop);
+		}
+
+		void stopWriter() {
+			{
+				std::scoped_lock<std::mutex> lock(s_WriterMutex);
+				s_WriterRunning = false;
+			}
+			s_WriterCondition.notify_one();
+			s_Writer.join();
+		}
+
+		void push(const ProfileEvent& event, const HardwareCounterValues* counters = nullptr) {
+			auto& buffer = getThreadBuffer();
+
+			const uint32_t tail = buffer.Tail.load(std::memory_order_relaxed);
+			if (tail - buffer.CachedHead == s_ThreadBufferCapacity) {
+				buffer.CachedHead = buffer.Head.load(std::memory_order_acquire);
+				if (tail - buffer.CachedHead == s_ThreadBufferCapacity) {
+					s_DroppedScopes.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+			}
+
+			if (counters) {
+				if (!buffer.Counters) {
+					VI_MEMORY_TAG(Debug);
+					buffer.Counters = createScope<HardwareCounterValues[]>(s_ThreadBufferCapacity);
+				}
+				buffer.Counters[tail % s_ThreadBufferCapacity] = *counters;
+			}
+
+			buffer.Events[tail % s_ThreadBufferCapacity] = event;
+			buffer.Tail.store(tail + 1, std::memory_order_release);
+
+			// A busy thread can fill its ring faster than the writer polls, ask for an early drain once it is half full
+			if (tail % (s_ThreadBufferCapacity / 4) == 0) {
+				buffer.CachedHead = buffer.Head.load(std::memory_order_acquire);
+				if (tail - buffer.CachedHead >= s_ThreadBufferCapacity / 2 && !s_DrainRequested.exchange(true, std::memory_order_relaxed)) {
+					s_WriterCondition.notify_one();
+				}
+			}
+		}
+
+#ifdef VI_PLATFORM_LINUX
+		void onDumpSignal(int) {
+			const char* expected{ nullptr };
+			s_DumpReason.compare_exchange_strong(expected, "signal", std::memory_order_acq_rel);
+		}
+#endif
+	}
+
+	void Instrumentor::beginSession(const std::string& name, const std::string& filepath) {
+		VI_MEMORY_TAG(Debug);
+		std::scoped_lock<std::mutex> lock(s_SessionMutex);
+
+		if (s_Mode.load(std::memory_order_relaxed) != Mode::None) {
+			// Profiling code that runs before Log::init would crash here, so only log once it is up
+			if (Log::getCoreLogger()) {
+				VI_CORE_ERROR("Instrumentor::beginSession('{0}') when a session is already open.", name);
+			}
+			internalEndSession();
+			internalEndFlightRecorder();
+		}
+
+		s_Output.open(filepath);
+		if (!s_Output) {
+			if (Log::getCoreLogger()) {
+				VI_CORE_ERROR("Instrumentor could not open results file '{0}'.", filepath);
+			}
+			return;
+		}
+
+		s_FirstEvent = true;
+		s_Json = "{\"otherData\": {},\"traceEvents\":[";
+
+		startWriter(Mode::Session);
+		s_Active.store(true, std::memory_order_release);
+	}
+
+	void Instrumentor::endSession() {
+		std::scoped_lock<std::mutex> lock(s_SessionMutex);
+		internalEndSession();
+	}
+
+	void Instrumentor::internalEndSession() {
+		if (s_Mode.load(std::memory_order_relaxed) != Mode::Session) {
+			return;
+		}
+
+		s_Active.store(false, std::memory_order_release);
+		stopWriter();
+		drainIntoSession();
+
+		appendThreadNames(s_Json, s_FirstEvent);
+		s_Json.append("\n]}");
+		flushJson();
+		s_Output.close();
+		s_Mode.store(Mode::None, std::memory_order_relaxed);
+	}
+
+	void Instrumentor::beginFlightRecorder(const FlightRecorderSpecification& specification) {
+		VI_MEMORY_TAG(Debug);
+		std::scoped_lock<std::mutex> lock(s_SessionMutex);
+
+		internalEndSession();
+		internalEndFlightRecorder();
+
+		s_FlightRecorder = specification;
+		s_FlightRecorder.HistoryCapacity = std::max(s_FlightRecorder.HistoryCapacity, 1u);
+		s_HitchThreshold.store(specification.HitchThreshold, std::memory_order_relaxed);
+		s_DumpReason.store(nullptr, std::memory_order_relaxed);
+		s_HasDumped = false;
+
+#ifdef VI_PLATFORM_LINUX
+		std::signal(SIGUSR1, onDumpSignal);
+#endif
+
+		startWriter(Mode::FlightRecorder);
+		s_Active.store(true, std::memory_order_release);
+
+		if (Log::getCoreLogger()) {
+			VI_CORE_INFO("Flight recorder keeps the last {0}s of profile scopes", specification.Duration);
+		}
+	}
+
+	void Instrumentor::endFlightRecorder() {
+		std::scoped_lock<std::mutex> lock(s_SessionMutex);
+		internalEndFlightRecorder();
+	}
+
+	void Instrumentor::internalEndFlightRecorder() {
+		if (s_Mode.load(std::memory_order_relaxed) != Mode::FlightRecorder) {
+			return;
+		}
+
+#ifdef VI_PLATFORM_LINUX
+		std::signal(SIGUSR1, SIG_DFL);
+#endif
+
+		s_Active.store(false, std::memory_order_release);
+		s_HitchThreshold.store(0.0f, std::memory_order_relaxed);
+		stopWriter();
+
+		// A dump requested right before shutdown is usually the interesting one
+		if (const char* reason = s_DumpReason.exchange(nullptr, std::memory_order_acq_rel)) {
+			writeDump(reason);
+		}
+
+		// The writer is gone, the history can be released from this thread
+		for (auto* buffer : getBuffers()) {
+			buffer->History = {};
+			buffer->HistoryCounters = {};
+			buffer->HistoryNext = 0;
+			buffer->HistoryCount = 0;
+		}
+		s_Mode.store(Mode::None, std::memory_order_relaxed);
+	}
+
+	void Instrumentor::dumpFlightRecorder(const char* reason) {
+		if (s_Mode.load(std::memory_order_relaxed) != Mode::FlightRecorder) {
+			return;
+		}
+
+		// Requests made while one is pending are folded into it, the first reason wins
+		const char* expected{ nullptr };
+		if (s_DumpReason.compare_exchange_strong(expected, reason, std::memory_order_acq_rel)) {
+			s_WriterCondition.notify_one();
+		}
+	}
+
+	void Instrumentor::markFrame(float seconds) {
+		const float threshold = s_HitchThreshold.load(std::memory_order_relaxed);
+		if (threshold > 0.0f && seconds * 1000.0f > threshold) {
+			dumpFlightRecorder("hitch");
+		}
+	}
+
+	void Instrumentor::setThreadName(const std::string& name) {
+		auto& buffer = getThreadBuffer();
+
+		std::scoped_lock<std::mutex> lock(s_BuffersMutex);
+		buffer.Name = name;
+	}
+
+	void Instrumentor::record(const char* name, uint64_t start, uint64_t end) {
+		push({ name, start, end, ProfileEventKind::Scope });
+	}
+
+	void Instrumentor::record(const char* name, uint64_t start, uint64_t end, const HardwareCounterValues& counters) {
+		push({ name, start, end, ProfileEventKind::ScopeWithCounters }, &counters);
+	}
+
+	void Instrumentor::recordCounter(const char* name, uint64_t value) {
+		if (isActive()) {
+			push({ name, getTimestamp(), value, ProfileEventKind::Counter });
+		}
+	}
+
+	uint64_t Instrumentor::getDroppedScopeCount() {
+		return s_DroppedScopes.load(std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "Vi/Debug/HardwareCounters.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#define VI_PROFILE_USE_TSC
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#include <chrono>
+#endif
+
+namespace Vi {
+    struct FlightRecorderSpecification {
+        // Seconds of history kept, bounded by HistoryCapacity scopes per thread
+        float Duration{ 10.0f };
+        uint32_t HistoryCapacity{ 1 << 17 };
+        // A frame taking longer than this many milliseconds triggers a dump, 0 disables it
+        float HitchThreshold{ 0.0f };
+        // Dumps requested sooner than this many seconds after the last one are skipped
+        float MinDumpInterval{ 30.0f };
+        std::string DumpDirectory{ "." };
+    };
+
+    // Chrome trace profiler. Scopes write into a lock-free ring owned by their thread and a background thread
+    // turns the rings into JSON, so a scope costs two timestamp reads and a ring write.
+    // Open the resulting file in chrome://tracing or ui.perfetto.dev.
+    class Instrumentor {
+    public:
+        static void beginSession(const std::string& name, const std::string& filepath = "results.json");
+        static void endSession();
+
+        // Continuous mode for long runs: only the most recent scopes are kept in memory and written out on request,
+        // when a frame exceeds the hitch threshold or, on Linux, when the process receives SIGUSR1.
+        // Runs instead of a session, starting either one ends the other.
+        static void beginFlightRecorder(const FlightRecorderSpecification& specification = {});
+        static void endFlightRecorder();
+        // Only records the request, the dump is written by the background thread. Ignored unless the flight recorder runs.
+        // Reason has to be a string literal.
+        static void dumpFlightRecorder(const char* reason = "request");
+
+        // Reports the duration of the last frame for hitch detection
+        static void markFrame(float seconds);
+
+        // Shows up as the name of the calling thread in the trace
+        static void setThreadName(const std::string& name);
+
+        [[nodiscard]] static bool isActive() {
+            return s_Active.load(std::memory_order_relaxed);
+        }
+
+        // Ticks of the raw timestamp source, converted to microseconds by the writer
+        static uint64_t getTimestamp() {
+#ifdef VI_PROFILE_USE_TSC
+            return __rdtsc();
+#else
+            return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+        }
+
+        static void record(const char* name, uint64_t start, uint64_t end);
+        // Counters are the difference over the scope and end up as arguments of the trace event
+        static void record(const char* name, uint64_t start, uint64_t end, const HardwareCounterValues& counters);
+        // Shows up as a counter track, the name has to outlive the session like scope names
+        static void recordCounter(const char* name, uint64_t value);
+
+        [[nodiscard]] static uint64_t getDroppedScopeCount();
+
+    private:
+        static void internalEndSession();
+        static void internalEndFlightRecorder();
+
+        static std::atomic<bool> s_Active;
+    };
+
+    class InstrumentationTimer {
+    public:
+        explicit InstrumentationTimer(const char* name): m_Name(name) {
+            // Counters are read outside of the timed region so the syscalls do not show up in the duration
+            m_HasCounters = HardwareCounters::isEnabled() && Instrumentor::isActive() && HardwareCounters::read(m_Counters);
+            m_Start = Instrumentor::getTimestamp();
+        }
+
+        ~InstrumentationTimer() {
+            if (!Instrumentor::isActive()) {
+                return;
+            }
+
+            const uint64_t end = Instrumentor::getTimestamp();
+            HardwareCounterValues counters;
+            if (m_HasCounters && HardwareCounters::read(counters)) {
+                // Scopes during which the counters never got onto the PMU are recorded without them
+                counters = counters - m_Counters;
+                if (counters.scaleToEnabledTime()) {
+                    Instrumentor::record(m_Name, m_Start, end, counters);
+                    return;
+                }
+            }
+
+            Instrumentor::record(m_Name, m_Start, end);
+        }
+
+        InstrumentationTimer(const InstrumentationTimer&) = delete;
+        InstrumentationTimer& operator=(const InstrumentationTimer&) = delete;
+
+    private:
+        const char* m_Name;
+        uint64_t m_Start;
+        HardwareCounterValues m_Counters;
+        bool m_HasCounters;
+    };
+}
+
+// Profiling is compiled in unless VI_PROFILE is defined to 0, it only records while a session is running
+#ifndef VI_PROFILE
+#define VI_PROFILE 1
+#endif
+
+#if VI_PROFILE
+#if defined(_MSC_VER)
+#define VI_FUNC_SIG __FUNCSIG__
+#elif defined(__GNUC__) || defined(__clang__)
+#define VI_FUNC_SIG __PRETTY_FUNCTION__
+#else
+#define VI_FUNC_SIG __func__
+#endif
+
+#define VI_PROFILE_BEGIN_SESSION(name, filepath) ::Vi::Instrumentor::beginSession(name, filepath)
+#define VI_PROFILE_END_SESSION() ::Vi::Instrumentor::endSession()
+#define VI_PROFILE_SCOPE_LINE2(name, line) ::Vi::InstrumentationTimer viProfileTimer##line(name)
+#define VI_PROFILE_SCOPE_LINE(name, line) VI_PROFILE_SCOPE_LINE2(name, line)
+// Names have to outlive the session, string literals and function signatures do
+#define VI_PROFILE_SCOPE(name) VI_PROFILE_SCOPE_LINE(name, __LINE__)
+#define VI_PROFILE_FUNCTION() VI_PROFILE_SCOPE(VI_FUNC_SIG)
+#define VI_PROFILE_THREAD(name) ::Vi::Instrumentor::setThreadName(name)
+#define VI_PROFILE_BEGIN_FLIGHT_RECORDER(specification) ::Vi::Instrumentor::beginFlightRecorder(specification)
+#define VI_PROFILE_END_FLIGHT_RECORDER() ::Vi::Instrumentor::endFlightRecorder()
+#define VI_PROFILE_FRAME(seconds) ::Vi::Instrumentor::markFrame(seconds)
+#define VI_PROFILE_COUNTER(name, value) ::Vi::Instrumentor::recordCounter(name, value)
+#else
+#define VI_PROFILE_BEGIN_SESSION(name, filepath)
+#define VI_PROFILE_END_SESSION()
+#define VI_PROFILE_SCOPE(name)
+#define VI_PROFILE_FUNCTION()
+#define VI_PROFILE_THREAD(name)
+#define VI_PROFILE_BEGIN_FLIGHT_RECORDER(specification)
+#define VI_PROFILE_END_FLIGHT_RECORDER()
+#define VI_PROFILE_FRAME(seconds)
+#define VI_PROFILE_COUNTER(name, value)
+#endif
@@ -0,0 +1,304 @@
+#include "vipch.hpp"
+#include "Vi/Debug/MemoryTracker.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace Vi {
+	namespace {
+		constexpr size_t s_TagCount{ static_cast<size_t>(MemoryTag::Count) };
+
+		constexpr std::array<const char*, s_TagCount> s_TagNames{
+			"General",
+			"Core",
+			"Log",
+			"Event",
+			"Layer",
+			"Jobs",
+			"Renderer",
+			"Scene",
+			"Scripting",
+			"Debug"
+		};
+
+		// Profiler counter names have to outlive the session
+		constexpr std::array<const char*, s_TagCount> s_CounterNames{
+			"Memory General",
+			"Memory Core",
+			"Memory Log",
+			"Memory Event",
+			"Memory Layer",
+			"Memory Jobs",
+			"Memory Renderer",
+			"Memory Scene",
+			"Memory Scripting",
+			"Memory Debug"
+		};
+
+		// Sits right in front of the memory handed out, the block start is kept to free over-aligned allocations
+		struct AllocationHeader {
+			void* Block;
+			std::size_t Size;
+			MemoryTag Tag;
+		};
+
+		// Own cache line per tag, threads allocating for different subsystems do not contend
+		struct alignas(64) TagCounters {
+			std::atomic<uint64_t> LiveBytes{ 0 };
+			std::atomic<uint64_t> PeakBytes{ 0 };
+			std::atomic<uint64_t> LiveAllocations{ 0 };
+			std::atomic<uint64_t> TotalBytes{ 0 };
+			std::atomic<uint64_t> TotalAllocations{ 0 };
+		};
+
+		// Allocations happen before main and during static destruction, all of this has to be constant initialized
+		constinit std::array<TagCounters, s_TagCount> s_Counters{};
+		constinit std::atomic<uint64_t> s_TotalLiveBytes{ 0 };
+		constinit std::atomic<uint64_t> s_TotalPeakBytes{ 0 };
+		constinit thread_local MemoryTag s_CurrentTag{ MemoryTag::General };
+
+		// Main thread only
+		MemoryFrameStats s_FrameStart;
+		MemoryFrameStats s_LastFrame;
+		std::array<MemoryTagStats, s_TagCount> s_Baseline{};
+
+		void updatePeak(std::atomic<uint64_t>& peak, uint64_t value) {
+			uint64_t current = peak.load(std::memory_order_relaxed);
+			while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+			}
+		}
+	}
+
+	const char* getMemoryTagName(MemoryTag tag) {
+		return tag < MemoryTag::Count ? s_TagNames[static_cast<size_t>(tag)] : "Unknown";
+	}
+
+	void* MemoryTracker::allocate(std::size_t size, std::size_t alignment) {
+		alignment = std::max(alignment, alignof(AllocationHeader));
+		const std::size_t overhead = sizeof(AllocationHeader) + alignment - 1;
+		if (size > SIZE_MAX - overhead) {
+			return nullptr;
+		}
+
+		void* block = std::malloc(size + overhead);
+		if (!block) {
+			return nullptr;
+		}
+
+		const uintptr_t address = (reinterpret_cast<uintptr_t>(block) + sizeof(AllocationHeader) + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+		const MemoryTag tag = s_CurrentTag;
+		new (reinterpret_cast<AllocationHeader*>(address) - 1) AllocationHeader{ block, size, tag };
+
+		auto& counters = s_Counters[static_cast<size_t>(tag)];
+		updatePeak(counters.PeakBytes, counters.LiveBytes.fetch_add(size, std::memory_order_relaxed) + size);
+		counters.LiveAllocations.fetch_add(1, std::memory_order_relaxed);
+		counters.TotalBytes.fetch_add(size, std::memory_order_relaxed);
+		counters.TotalAllocations.fetch_add(1, std::memory_order_relaxed);
+		updatePeak(s_TotalPeakBytes, s_TotalLiveBytes.fetch_add(size, std::memory_order_relaxed) + size);
+
+		return reinterpret_cast<void*>(address);
+	}
+
+	void MemoryTracker::deallocate(void* memory) {
+		if (!memory) {
+			return;
+		}
+
+		// Charged to the tag it was allocated with, whichever thread frees it
+		const auto* header = static_cast<AllocationHeader*>(memory) - 1;
+		auto& counters = s_Counters[static_cast<size_t>(header->Tag)];
+		counters.LiveBytes.fetch_sub(header->Size, std::memory_order_relaxed);
+		counters.LiveAllocations.fetch_sub(1, std::memory_order_relaxed);
+		s_TotalLiveBytes.fetch_sub(header->Size, std::memory_order_relaxed);
+
+		std::free(header->Block);
+	}
+
+	MemoryTag MemoryTracker::getCurrentTag() {
+		return s_CurrentTag;
+	}
+
+	void MemoryTracker::setCurrentTag(MemoryTag tag) {
+		s_CurrentTag = tag;
+	}
+
+	MemoryTagStats MemoryTracker::getStats(MemoryTag tag) {
+		VI_CORE_ASSERT(tag < MemoryTag::Count, "Invalid memory tag!");
+
+		const auto& counters = s_Counters[static_cast<size_t>(tag)];
+		MemoryTagStats stats;
+		stats.LiveBytes = counters.LiveBytes.load(std::memory_order_relaxed);
+		stats.PeakBytes = counters.PeakBytes.load(std::memory_order_relaxed);
+		stats.LiveAllocations = counters.LiveAllocations.load(std::memory_order_relaxed);
+		stats.TotalBytes = counters.TotalBytes.load(std::memory_order_relaxed);
+		stats.TotalAllocations = counters.TotalAllocations.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	MemoryTagStats MemoryTracker::getTotalStats() {
+		MemoryTagStats total;
+		for (size_t index = 0; index < s_TagCount; index++) {
+			const auto stats = getStats(static_cast<MemoryTag>(index));
+			total.LiveAllocations += stats.LiveAllocations;
+			total.TotalBytes += stats.TotalBytes;
+			total.TotalAllocations += stats.TotalAllocations;
+		}
+
+		total.LiveBytes = s_TotalLiveBytes.load(std::memory_order_relaxed);
+		total.PeakBytes = s_TotalPeakBytes.load(std::memory_order_relaxed);
+		return total;
+	}
+
+	MemoryFrameStats MemoryTracker::getLastFrameStats() {
+		return s_LastFrame;
+	}
+
+	void MemoryTracker::endFrame() {
+		if constexpr (!isEnabled()) {
+			return;
+		}
+
+		const auto total = getTotalStats();
+		s_LastFrame = { total.TotalAllocations - s_FrameStart.Allocations, total.TotalBytes - s_FrameStart.Bytes };
+		s_FrameStart = { total.TotalAllocations, total.TotalBytes };
+
+		if (!Instrumentor::isActive()) {
+			return;
+		}
+
+		VI_PROFILE_COUNTER("Memory Total", total.LiveBytes);
+		VI_PROFILE_COUNTER("Allocations per frame", s_LastFrame.Allocations);
+		for (size_t index = 0; index < s_TagCount; index++) {
+			VI_PROFILE_COUNTER(s_CounterNames[index], s_Counters[index].LiveBytes.load(std::memory_order_relaxed));
+		}
+	}
+
+	void MemoryTracker::captureBaseline() {
+		for (size_t index = 0; index < s_TagCount; index++) {
+			s_Baseline[index] = getStats(static_cast<MemoryTag>(index));
+		}
+
+		const auto total = getTotalStats();
+		s_FrameStart = { total.TotalAllocations, total.TotalBytes };
+	}
+
+	void MemoryTracker::reportLeaks() {
+		if constexpr (!isEnabled()) {
+			return;
+		}
+
+		bool leaked{ false };
+		for (size_t index = 0; index < s_TagCount; index++) {
+			// The profiler keeps its per-thread buffers for reuse until the process exits
+			if (static_cast<MemoryTag>(index) == MemoryTag::Debug) {
+				continue;
+			}
+
+			const auto stats = getStats(static_cast<MemoryTag>(index));
+			if (stats.LiveAllocations <= s_Baseline[index].LiveAllocations) {
+				continue;
+			}
+
+			VI_CORE_WARN("Memory leak: {0} allocations ({1} bytes) tagged {2} are still live",
+				stats.LiveAllocations - s_Baseline[index].LiveAllocations, static_cast<int64_t>(stats.LiveBytes - s_Baseline[index].LiveBytes), s_TagNames[index]);
+			leaked = true;
+		}
+
+		const auto total = getTotalStats();
+		if (!leaked) {
+			VI_CORE_INFO("No leaked allocations, peak heap usage was {0} bytes", total.PeakBytes);
+		}
+	}
+}
+
+#if VI_TRACK_MEMORY
+namespace {
+	void* allocateOrThrow(std::size_t size, std::size_t alignment) {
+		void* memory = Vi::MemoryTracker::allocate(size, alignment);
+		if (!memory) {
+			throw std::bad_alloc();
+		}
+		return memory;
+	}
+}
+
+void* operator new(std::size_t size) {
+	return allocateOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](std::size_t size) {
+	return allocateOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+	return allocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+	return allocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	return Vi::MemoryTracker::allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	return Vi::MemoryTracker::allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return Vi::MemoryTracker::allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return Vi::MemoryTracker::allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* memory) noexcept {
+	Vi::MemoryTracker::deallocate(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+	Vi::MemoryTracker::deallocate(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+	Vi::MemoryTracker::deallocate(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+	Vi::MemoryTracker::deallocate(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+	Vi::MemoryTracker::deallocate(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept {
+	Vi::MemoryTracker::deallocate(memory);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept {
+	Vi::MemoryTracker::deallocate(memory);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept {
+	Vi::MemoryTracker::deallocate(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+	Vi::MemoryTracker::deallocate(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+	Vi::MemoryTracker::deallocate(memory);
+}
+
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept {
+	Vi::MemoryTracker::deallocate(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept {
+	Vi::MemoryTracker::deallocate(memory);
+}
+#endif
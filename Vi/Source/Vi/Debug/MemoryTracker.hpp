@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Replaces the global allocation operators to account every heap allocation to the subsystem that made it.
+// Opt-in because every allocation pays for a small header and a few atomic counters, enabled with premake --track-memory.
+// The workspace defines VI_TRACK_MEMORY for every project, a translation unit falling back to its own value would break the ODR.
+#ifndef VI_TRACK_MEMORY
+#error "VI_TRACK_MEMORY has to be defined to 0 or 1 for the whole build, premake5.lua does this"
+#endif
+
+namespace Vi {
+    // Subsystem an allocation is charged to, set per thread with VI_MEMORY_TAG
+    enum class MemoryTag : uint8_t {
+        General,
+        Core,
+        Log,
+        Event,
+        Layer,
+        Jobs,
+        Renderer,
+        Scene,
+        Scripting,
+        Debug,
+
+        Count
+    };
+
+    [[nodiscard]] const char* getMemoryTagName(MemoryTag tag);
+
+    struct MemoryTagStats {
+        uint64_t LiveBytes{ 0 };
+        uint64_t PeakBytes{ 0 };
+        uint64_t LiveAllocations{ 0 };
+        // Totals since startup, frees are not subtracted
+        uint64_t TotalBytes{ 0 };
+        uint64_t TotalAllocations{ 0 };
+    };
+
+    struct MemoryFrameStats {
+        uint64_t Allocations{ 0 };
+        uint64_t Bytes{ 0 };
+    };
+
+    class MemoryTracker {
+    public:
+        [[nodiscard]] static constexpr bool isEnabled() {
+            return VI_TRACK_MEMORY != 0;
+        }
+
+        // Used by the replaced allocation operators, returns nullptr when out of memory
+        static void* allocate(std::size_t size, std::size_t alignment);
+        static void deallocate(void* memory);
+
+        [[nodiscard]] static MemoryTag getCurrentTag();
+        static void setCurrentTag(MemoryTag tag);
+
+        [[nodiscard]] static MemoryTagStats getStats(MemoryTag tag);
+        // Summed over all tags, the peak is the peak of the sum
+        [[nodiscard]] static MemoryTagStats getTotalStats();
+
+        // Allocations made during the last completed frame
+        [[nodiscard]] static MemoryFrameStats getLastFrameStats();
+        // Closes the current frame and publishes live bytes per tag as profiler counters, call once per frame
+        static void endFrame();
+
+        // Live allocations at this point are not reported as leaks later
+        static void captureBaseline();
+        // Logs every tag that holds more live allocations than at the baseline
+        static void reportLeaks();
+    };
+
+    class MemoryTagScope {
+    public:
+        explicit MemoryTagScope(MemoryTag tag): m_Previous(MemoryTracker::getCurrentTag()) {
+            MemoryTracker::setCurrentTag(tag);
+        }
+
+        ~MemoryTagScope() {
+            MemoryTracker::setCurrentTag(m_Previous);
+        }
+
+        MemoryTagScope(const MemoryTagScope&) = delete;
+        MemoryTagScope& operator=(const MemoryTagScope&) = delete;
+
+    private:
+        MemoryTag m_Previous;
+    };
+}
+
+#if VI_TRACK_MEMORY
+#define VI_MEMORY_TAG_LINE2(tag, line) ::Vi::MemoryTagScope viMemoryTag##line(::Vi::MemoryTag::tag)
+#define VI_MEMORY_TAG_LINE(tag, line) VI_MEMORY_TAG_LINE2(tag, line)
+// Charges allocations made by this thread until the end of the scope to the tag
+#define VI_MEMORY_TAG(tag) VI_MEMORY_TAG_LINE(tag, __LINE__)
+#else
+#define VI_MEMORY_TAG(tag)
+#endif
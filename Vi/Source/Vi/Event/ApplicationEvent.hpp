@@ -1,13 +1,62 @@
 #pragma once
 #include "Vi/Event/Event.hpp"
 
+#include <cstdint>
+
 namespace Vi {
     class WindowCloseEvent: public Event {
     public:
-        WindowCloseEvent() : Event(EventType::WindowClose) {
+        WindowCloseEvent() : Event(getStaticType()) {
+
+        }
+
+        static EventType getStaticType() {
+            return EventType::WindowClose;
+        }
+    };
+
+    class WindowResizeEvent: public Event {
+    public:
+        WindowResizeEvent(uint32_t width, uint32_t height) : Event(getStaticType()), m_Width(width), m_Height(height) {
+
+        }
+
+        static EventType getStaticType() {
+            return EventType::WindowResize;
+        }
+
+        uint32_t getWidth() const {
+            return m_Width;
+        }
+
+        uint32_t getHeight() const {
+            return m_Height;
+        }
+
+    private:
+        uint32_t m_Width;
+        uint32_t m_Height;
+    };
+
+    class WindowFocusEvent: public Event {
+    public:
+        WindowFocusEvent() : Event(getStaticType()) {
+
+        }
+
+        static EventType getStaticType() {
+            return EventType::WindowFocus;
+        }
+    };
+
+    class WindowLostFocusEvent: public Event {
+    public:
+        WindowLostFocusEvent() : Event(getStaticType()) {
 
         }
 
-        ~WindowCloseEvent() override = default;
+        static EventType getStaticType() {
+            return EventType::WindowLostFocus;
+        }
     };
 }
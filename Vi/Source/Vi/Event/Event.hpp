@@ -1,33 +1,38 @@
 #pragma once
-#include <memory>
+#include <cstdint>
 
 namespace Vi {
-    enum class EventType {
+    enum class EventType : uint16_t {
         None = 0,
         WindowClose,
+        WindowResize,
+        WindowFocus,
+        WindowLostFocus,
+        KeyPressed,
+        KeyReleased,
+        KeyTyped,
+        MouseButtonPressed,
+        MouseButtonReleased,
+        MouseMoved,
+        MouseScrolled,
     };
 
+    // Events are plain values: no virtual functions, the concrete type is recovered from getType()
     class Event {
     public:
         explicit Event(const EventType type) : m_Type(type) {
 
         }
 
-        virtual ~Event() = default;
-
         EventType getType() const {
             return m_Type;
         }
 
+    protected:
+        // Not virtual, events are destroyed through their concrete type by the EventDispatcher
+        ~Event() = default;
+
     private:
         EventType m_Type;
     };
-
-    using EventPointer = std::shared_ptr<Event>;
-
-    struct EventPolicy {
-        static EventType getEvent(const EventPointer& event) {
-            return event->getType();
-        }
-    };
 }
@@ -1,16 +1,350 @@
 #include "vipch.hpp"
 #include "Vi/Event/EventDispatcher.hpp"
 
+#include "Vi/Event/ApplicationEvent.hpp"
+#include "Vi/Event/KeyEvent.hpp"
+#include "Vi/Event/MouseEvent.hpp"
+
 namespace Vi {
-	void EventDispatcher::addListener(EventType type, std::function<void(const EventPointer&)> callback) {
-		m_Queue.appendListener(type, callback);
+	namespace {
+		std::atomic<uint64_t> s_NextDispatcherId{ 1 };
+
+		// Queue of the last dispatcher this thread posted to, keyed by id so a new dispatcher at the same address is not confused with it
+		struct ProducerCache {
+			uint64_t DispatcherId{ 0 };
+			void* Queue{ nullptr };
+		};
+
+		thread_local ProducerCache s_ProducerCache;
+	}
+
+	EventDispatcher::EventDispatcher(): m_Id(s_NextDispatcherId.fetch_add(1, std::memory_order_relaxed)) {
+		registerEventType<WindowCloseEvent>();
+		registerEventType<WindowResizeEvent>();
+		registerEventType<WindowFocusEvent>();
+		registerEventType<WindowLostFocusEvent>();
+		registerEventType<KeyPressedEvent>();
+		registerEventType<KeyReleasedEvent>();
+		registerEventType<KeyTypedEvent>();
+		registerEventType<MouseButtonPressedEvent>();
+		registerEventType<MouseButtonReleasedEvent>();
+		registerEventType<MouseMovedEvent>();
+		registerEventType<MouseScrolledEvent>();
+
+		// High frequency events where only the end result of a frame matters
+		setCoalescing(EventType::WindowResize, true);
+		setCoalescing(EventType::MouseMoved, true);
+		setCoalescing(EventType::MouseScrolled, true);
+		setCoalescing(EventType::KeyPressed, true);
+
+		// Built-in events come from the window, nothing may hold them back
+		for (size_t index = 1; index < m_EventTypes.size(); index++) {
+			setRecording(static_cast<EventType>(index), true);
+			setPriority(static_cast<EventType>(index), EventPriority::Critical);
+		}
+	}
+
+	EventDispatcher::~EventDispatcher() {
+		clear(m_Queues[0]);
+		clear(m_Queues[1]);
+
+		// Posted but never processed, a queue may outlive the dispatcher until its thread exits
+		std::scoped_lock<std::mutex> lock(m_ProducersMutex);
+		for (auto& producer : m_Producers) {
+			const uint32_t tail = producer->Tail.load(std::memory_order_acquire);
+			uint32_t head = producer->Head.load(std::memory_order_relaxed);
+
+			for (; head != tail; head++) {
+				auto& slot = producer->Slots[head % s_PostedQueueCapacity];
+				slot.Destroy(slot.Storage);
+			}
+
+			producer->Head.store(head, std::memory_order_release);
+		}
+	}
+
+	void EventDispatcher::sendEvent(const Event& event) {
+		if (!isRegistered(event.getType())) {
+			VI_CORE_ERROR("Event type {0} is not registered with the EventDispatcher", static_cast<uint32_t>(event.getType()));
+			return;
+		}
+
+		// Moves need a delta, the typed path fills it in
+		if (event.getType() == EventType::MouseMoved) {
+			const auto& move = static_cast<const MouseMovedEvent&>(event);
+			sendEvent<MouseMovedEvent>(move.getX(), move.getY());
+			return;
+		}
+
+		const auto& info = m_EventTypes[static_cast<size_t>(event.getType())];
+		if (info.CoalesceEnabled) {
+			if (tryCoalesce(event)) {
+				return;
+			}
+		}
+		else {
+			breakCoalescing();
+		}
+
+		auto& queue = m_Queues[m_WriteQueue];
+		queue.Events.push_back({ info.Copy(queue.Arena.allocate(info.Size, info.Alignment), event), nextSequence() });
+	}
+
+	void EventDispatcher::setCoalescing(EventType type, bool enabled) {
+		if (!isRegistered(type)) {
+			VI_CORE_ERROR("Event type {0} is not registered with the EventDispatcher", static_cast<uint32_t>(type));
+			return;
+		}
+
+		auto& info = m_EventTypes[static_cast<size_t>(type)];
+		VI_CORE_ASSERT(!enabled || info.Coalesce, "Event type can not be coalesced!");
+		info.CoalesceEnabled = enabled && info.Coalesce;
+		breakCoalescing();
+	}
+
+	void EventDispatcher::setRecording(EventType type, bool enabled) {
+		if (!isRegistered(type)) {
+			VI_CORE_ERROR("Event type {0} is not registered with the EventDispatcher", static_cast<uint32_t>(type));
+			return;
+		}
+
+		auto& info = m_EventTypes[static_cast<size_t>(type)];
+		VI_CORE_ASSERT(!enabled || info.Recordable, "Event type can not be recorded, it has to be trivially copyable!");
+		info.RecordEnabled = enabled && info.Recordable;
+	}
+
+	void EventDispatcher::setPriority(EventType type, EventPriority priority) {
+		if (!isRegistered(type)) {
+			VI_CORE_ERROR("Event type {0} is not registered with the EventDispatcher", static_cast<uint32_t>(type));
+			return;
+		}
+
+		m_EventTypes[static_cast<size_t>(type)].Priority = priority;
+	}
+
+	void EventDispatcher::sendRecordedEvent(EventType type, const void* data, size_t size) {
+		if (!isRegistered(type) || !m_EventTypes[static_cast<size_t>(type)].Recordable) {
+			VI_CORE_ERROR("Recorded event type {0} can not be replayed", static_cast<uint32_t>(type));
+			return;
+		}
+
+		const auto& info = m_EventTypes[static_cast<size_t>(type)];
+		if (info.Size != size) {
+			VI_CORE_ERROR("Recorded event type {0} has a different size than in this build", static_cast<uint32_t>(type));
+			return;
+		}
+
+		// Recorded events were coalesced already when they were dispatched
+		breakCoalescing();
+
+		auto& queue = m_Queues[m_WriteQueue];
+		auto* storage = queue.Arena.allocate(info.Size, info.Alignment);
+		std::memcpy(storage, data, size);
+		auto* event = std::launder(static_cast<Event*>(storage));
+		queue.Events.push_back({ event, nextSequence() });
+
+		// The recorded delta is kept, later moves continue from this position
+		if (type == EventType::MouseMoved) {
+			const auto& move = static_cast<const MouseMovedEvent&>(*event);
+			m_MouseX = move.m_MouseX;
+			m_MouseY = move.m_MouseY;
+			m_HasMousePosition = true;
+		}
+	}
+
+	bool EventDispatcher::tryCoalesce(const Event& event) {
+		const auto index = static_cast<size_t>(event.getType());
+		auto& queue = m_Queues[m_WriteQueue];
+		auto& pending = m_PendingCoalesce[index];
+
+		if (pending != s_NoPendingEvent && m_EventTypes[index].Coalesce(*queue.Events[pending].Data, event)) {
+			m_CoalescedEvents++;
+			return true;
+		}
+
+		// Not merged, the event about to be queued is a barrier for every other type and the one later events of its type merge into
+		breakCoalescing();
+		pending = queue.Events.size();
+		m_HasPendingCoalesce = true;
+		return false;
 	}
 
-	void EventDispatcher::sendEvent(EventPointer event) {
-		m_Queue.enqueue(event);
+	void EventDispatcher::trackMouseMove(Event& event) {
+		auto& move = static_cast<MouseMovedEvent&>(event);
+		if (m_HasMousePosition) {
+			move.m_DeltaX = move.m_MouseX - m_MouseX;
+			move.m_DeltaY = move.m_MouseY - m_MouseY;
+		}
+
+		m_MouseX = move.m_MouseX;
+		m_MouseY = move.m_MouseY;
+		m_HasMousePosition = true;
+	}
+
+	void EventDispatcher::breakCoalescing() {
+		if (m_HasPendingCoalesce) {
+			std::fill(m_PendingCoalesce.begin(), m_PendingCoalesce.end(), s_NoPendingEvent);
+			m_HasPendingCoalesce = false;
+		}
+	}
+
+	EventDispatcher::ProducerQueue& EventDispatcher::getProducerQueue() {
+		if (s_ProducerCache.DispatcherId == m_Id) {
+			return *static_cast<ProducerQueue*>(s_ProducerCache.Queue);
+		}
+
+		// Every queue this thread posted to, kept alive until it exits even if the dispatcher is gone by then
+		struct ThreadQueues {
+			std::vector<std::pair<uint64_t, Ref<ProducerQueue>>> Queues;
+
+			~ThreadQueues() {
+				for (auto& [dispatcherId, queue] : Queues) {
+					queue->Retired.store(true, std::memory_order_release);
+				}
+			}
+		};
+		thread_local ThreadQueues s_ThreadQueues;
+
+		auto it = std::find_if(s_ThreadQueues.Queues.begin(), s_ThreadQueues.Queues.end(), [this](const auto& entry) { return entry.first == m_Id; });
+		if (it == s_ThreadQueues.Queues.end()) {
+			// First post from this thread, the only time posting takes a lock
+			auto queue = createRef<ProducerQueue>();
+			{
+				std::scoped_lock<std::mutex> lock(m_ProducersMutex);
+				m_Producers.push_back(queue);
+			}
+			it = s_ThreadQueues.Queues.insert(s_ThreadQueues.Queues.end(), { m_Id, std::move(queue) });
+		}
+
+		s_ProducerCache = { m_Id, it->second.get() };
+		return *it->second;
+	}
+
+	void EventDispatcher::mergePostedEvents() {
+		auto& queue = m_Queues[m_WriteQueue];
+
+		std::scoped_lock<std::mutex> lock(m_ProducersMutex);
+		m_PostedRanges.clear();
+		for (auto& producer : m_Producers) {
+			// Checked before the tail, a retired queue receives nothing after its last tail update
+			const bool retired = producer->Retired.load(std::memory_order_acquire);
+			const uint32_t tail = producer->Tail.load(std::memory_order_acquire);
+			m_PostedRanges.push_back({ producer.get(), producer->Head.load(std::memory_order_relaxed), tail, retired });
+		}
+
+		// Every queue is in post order already, repeatedly take the oldest front event among them
+		for (;;) {
+			PostedRange* oldest{ nullptr };
+			uint64_t oldestTimestamp{ 0 };
+			for (auto& range : m_PostedRanges) {
+				if (range.Head == range.Tail) {
+					continue;
+				}
+
+				const uint64_t timestamp = range.Producer->Slots[range.Head % s_PostedQueueCapacity].Timestamp;
+				if (!oldest || timestamp < oldestTimestamp) {
+					oldest = &range;
+					oldestTimestamp = timestamp;
+				}
+			}
+
+			if (!oldest) {
+				break;
+			}
+
+			auto& slot = oldest->Producer->Slots[oldest->Head % s_PostedQueueCapacity];
+			if (!isRegistered(slot.Type)) {
+				(this->*slot.Register)();
+			}
+
+			auto* event = slot.Relocate(queue.Arena.allocate(slot.Size, slot.Alignment), slot.Storage);
+			if (slot.Type == EventType::MouseMoved) {
+				trackMouseMove(*event);
+			}
+			queue.Events.push_back({ event, nextSequence() });
+			oldest->Head++;
+		}
+
+		size_t kept{ 0 };
+		for (size_t index = 0; index < m_PostedRanges.size(); index++) {
+			m_PostedRanges[index].Producer->Head.store(m_PostedRanges[index].Head, std::memory_order_release);
+			if (!m_PostedRanges[index].Retired) {
+				m_Producers[kept++] = std::move(m_Producers[index]);
+			}
+		}
+		m_Producers.resize(kept);
 	}
 
 	void EventDispatcher::process() {
-		m_Queue.process();
+		VI_PROFILE_FUNCTION();
+		VI_MEMORY_TAG(Event);
+
+		mergePostedEvents();
+
+		auto& queue = m_Queues[m_WriteQueue];
+		m_WriteQueue ^= 1;
+		breakCoalescing();
+
+		// Queued in sequence order already, this only moves higher priority events to the front
+		const auto order = [this](const QueuedEvent& a, const QueuedEvent& b) {
+			const auto priorityA = m_EventTypes[static_cast<size_t>(a.Data->getType())].Priority;
+			const auto priorityB = m_EventTypes[static_cast<size_t>(b.Data->getType())].Priority;
+			return priorityA != priorityB ? priorityA < priorityB : a.Sequence < b.Sequence;
+		};
+		if (!std::is_sorted(queue.Events.begin(), queue.Events.end(), order)) {
+			std::sort(queue.Events.begin(), queue.Events.end(), order);
+		}
+
+		const Timer timer;
+		const double budget = m_ProcessingBudget * 1e-6;
+
+		for (size_t i = 0; i < queue.Events.size(); i++) {
+			auto* event = queue.Events[i].Data;
+			const auto index = static_cast<size_t>(event->getType());
+			if (budget > 0.0 && m_EventTypes[index].Priority != EventPriority::Critical && timer.elapsedSeconds() >= budget) {
+				defer(queue, i);
+				break;
+			}
+
+			if (m_Recorder && m_EventTypes[index].RecordEnabled) {
+				m_Recorder->record(*event, m_EventTypes[index].Size);
+			}
+
+			if (index < m_Listeners.size()) {
+				for (const auto& listener : m_Listeners[index]) {
+					listener.Invoke(listener.Instance, *event);
+				}
+			}
+
+			for (const auto& listener : m_GlobalListeners) {
+				listener.Invoke(listener.Instance, *event);
+			}
+		}
+
+		clear(queue);
+	}
+
+	void EventDispatcher::defer(Queue& queue, size_t first) {
+		// Moved into the queue of the next frame, keeping their sequence so they stay ahead of newer events of the same priority
+		auto& next = m_Queues[m_WriteQueue];
+		for (size_t i = first; i < queue.Events.size(); i++) {
+			const auto& [event, sequence] = queue.Events[i];
+			const auto& info = m_EventTypes[static_cast<size_t>(event->getType())];
+
+			next.Events.push_back({ info.Copy(next.Arena.allocate(info.Size, info.Alignment), *event), sequence });
+			info.Destroy(*event);
+		}
+
+		m_DeferredEvents += queue.Events.size() - first;
+		queue.Events.resize(first);
+	}
+
+	void EventDispatcher::clear(Queue& queue) {
+		for (const auto& [event, sequence] : queue.Events) {
+			m_EventTypes[static_cast<size_t>(event->getType())].Destroy(*event);
+		}
+
+		queue.Events.clear();
+		queue.Arena.reset();
 	}
 }
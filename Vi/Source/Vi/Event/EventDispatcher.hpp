@@ -1,17 +1,355 @@
 #pragma once
-#include "eventpp/eventqueue.h"
-
+#include "Vi/Core/Base.hpp"
+#include "Vi/Core/FrameArena.hpp"
 #include "Vi/Event/Event.hpp"
+#include "Vi/Event/EventRecorder.hpp"
 
-#define VI_BIND_EVENT_FN(fn) [this](auto&&... args) -> decltype(auto) { return this->fn(std::forward<decltype(args)>(args)...); }
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <mutex>
+#include <type_traits>
+#include <vector>
 
 namespace Vi {
+    // Critical events are delivered first and never deferred, the others are delivered in priority order while the
+    // processing budget lasts and the rest waits for the next frame
+    enum class EventPriority : uint8_t {
+        Critical = 0,
+        Normal,
+        Low
+    };
+
+    namespace Internal {
+        // Extracts the event type a listener function takes
+        template<typename Function>
+        struct ListenerTraits;
+
+        template<typename R, typename E>
+        struct ListenerTraits<R(*)(E&)> {
+            using EventT = E;
+        };
+
+        template<typename R, typename C, typename E>
+        struct ListenerTraits<R(C::*)(E&)> {
+            using EventT = E;
+        };
+
+        template<typename R, typename C, typename E>
+        struct ListenerTraits<R(C::*)(E&) const> {
+            using EventT = E;
+        };
+    }
+
+    // Queues events by value in a frame arena and delivers them in process(). Nothing is allocated per event once
+    // the arena and queue have grown to the usual frame load.
+    // Listeners are bound at compile time and receive the concrete event type; a listener taking Event& receives every event.
+    // sendEvent and process belong to the main thread, other threads use postEvent which writes to a queue owned by the
+    // posting thread. Those queues are merged in process() behind the events sent so far, ordered by the time they were posted.
     class EventDispatcher {
     public:
-        void addListener(EventType type, std::function<void(const EventPointer&)> callback);
-        void sendEvent(EventPointer event);
+        static constexpr size_t s_MaxPostedEventSize{ 64 };
+        static constexpr uint32_t s_PostedQueueCapacity{ 1024 };
+
+        EventDispatcher();
+        ~EventDispatcher();
+
+        EventDispatcher(const EventDispatcher&) = delete;
+        EventDispatcher& operator=(const EventDispatcher&) = delete;
+
+        // Makes sendEvent(const Event&) able to copy events of this type, the built-in events are registered already
+        template<typename T>
+        void registerEventType() {
+            const auto index = static_cast<size_t>(T::getStaticType());
+            if (index >= m_EventTypes.size()) {
+                m_EventTypes.resize(index + 1);
+            }
+
+            auto& info = m_EventTypes[index];
+            info.Size = sizeof(T);
+            info.Alignment = alignof(T);
+            info.Copy = [](void* destination, const Event& source) -> Event* {
+                return new (destination) T(static_cast<const T&>(source));
+            };
+            info.Destroy = [](Event& event) {
+                static_cast<T&>(event).~T();
+            };
+
+            // Types may define how two events merge, otherwise the newer one replaces the older
+            if constexpr (requires(T& pending, const T& incoming) { { T::coalesce(pending, incoming) } -> std::convertible_to<bool>; }) {
+                info.Coalesce = [](Event& pending, const Event& incoming) -> bool {
+                    return T::coalesce(static_cast<T&>(pending), static_cast<const T&>(incoming));
+                };
+            }
+            else if constexpr (std::is_copy_assignable_v<T>) {
+                info.Coalesce = [](Event& pending, const Event& incoming) -> bool {
+                    static_cast<T&>(pending) = static_cast<const T&>(incoming);
+                    return true;
+                };
+            }
+
+            info.Recordable = std::is_trivially_copyable_v<T> && sizeof(T) <= UINT16_MAX;
+
+            m_PendingCoalesce.resize(m_EventTypes.size(), s_NoPendingEvent);
+        }
+
+        // Merges events of this type sent within one frame into the one already queued, as long as no event
+        // of another type was queued in between. Only applies to sendEvent, posted events are never merged.
+        void setCoalescing(EventType type, bool enabled);
+
+        [[nodiscard]] uint64_t getCoalescedEventCount() const {
+            return m_CoalescedEvents;
+        }
+
+        // Every dispatched event of a type with recording enabled is written to the recorder, nullptr stops recording.
+        // Only the built-in window and input events are recorded by default, events raised by game code are expected
+        // to be raised again when the recorded input is replayed.
+        void setRecorder(EventRecorder* recorder) {
+            m_Recorder = recorder;
+        }
+
+        void setRecording(EventType type, bool enabled);
+
+        // Event types default to Normal, the built-in window and input events are Critical
+        void setPriority(EventType type, EventPriority priority);
+
+        // Microseconds process() may spend on events that are not critical, 0 delivers everything every frame
+        void setProcessingBudget(uint32_t microseconds) {
+            m_ProcessingBudget = microseconds;
+        }
+
+        // Counts an event once for every frame it was held back
+        [[nodiscard]] uint64_t getDeferredEventCount() const {
+            return m_DeferredEvents;
+        }
+
+        // Queues an event from its recorded bytes, used by the EventReplayer
+        void sendRecordedEvent(EventType type, const void* data, size_t size);
+
+        // Member function listener, e.g. addListener<&Application::onWindowResize>(this)
+        template<auto Method, typename Class>
+        void addListener(Class* instance) {
+            using EventT = typename Internal::ListenerTraits<decltype(Method)>::EventT;
+
+            addDelegate<EventT>({ instance, [](void* target, Event& event) {
+                (static_cast<Class*>(target)->*Method)(static_cast<EventT&>(event));
+            } });
+        }
+
+        // Free function listener
+        template<auto Function>
+        void addListener() {
+            using EventT = typename Internal::ListenerTraits<decltype(Function)>::EventT;
+
+            addDelegate<EventT>({ nullptr, [](void*, Event& event) {
+                Function(static_cast<EventT&>(event));
+            } });
+        }
+
+        template<typename T, typename... Args>
+        void sendEvent(Args&&... args) {
+            if (!isRegistered(T::getStaticType())) {
+                registerEventType<T>();
+            }
+
+            if (m_EventTypes[static_cast<size_t>(T::getStaticType())].CoalesceEnabled) {
+                T event(std::forward<Args>(args)...);
+                if (T::getStaticType() == EventType::MouseMoved) {
+                    trackMouseMove(event);
+                }
+
+                if (!tryCoalesce(event)) {
+                    auto& queue = m_Queues[m_WriteQueue];
+                    queue.Events.push_back({ queue.Arena.create<T>(event), nextSequence() });
+                }
+                return;
+            }
+
+            breakCoalescing();
+
+            auto& queue = m_Queues[m_WriteQueue];
+            T* event = queue.Arena.create<T>(std::forward<Args>(args)...);
+            if (T::getStaticType() == EventType::MouseMoved) {
+                trackMouseMove(*event);
+            }
+            queue.Events.push_back({ event, nextSequence() });
+        }
+
+        // Lock-free from any thread, returns false and drops the event when the thread's queue is full
+        template<typename T, typename... Args>
+        bool postEvent(Args&&... args) {
+            static_assert(sizeof(T) <= s_MaxPostedEventSize && alignof(T) <= alignof(std::max_align_t), "Event is too large to be posted!");
+
+            auto& queue = getProducerQueue();
+            const uint32_t tail = queue.Tail.load(std::memory_order_relaxed);
+            if (tail - queue.Head.load(std::memory_order_acquire) == s_PostedQueueCapacity) {
+                m_DroppedEvents.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            auto& slot = queue.Slots[tail % s_PostedQueueCapacity];
+            new (slot.Storage) T(std::forward<Args>(args)...);
+            slot.Timestamp = getPostTimestamp();
+            slot.Type = T::getStaticType();
+            slot.Register = &EventDispatcher::registerEventType<T>;
+            slot.Relocate = [](void* destination, void* source) -> Event* {
+                auto* event = new (destination) T(std::move(*static_cast<T*>(source)));
+                static_cast<T*>(source)->~T();
+                return event;
+            };
+            slot.Destroy = [](void* event) {
+                static_cast<T*>(event)->~T();
+            };
+            slot.Size = sizeof(T);
+            slot.Alignment = alignof(T);
+
+            queue.Tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        [[nodiscard]] uint64_t getDroppedEventCount() const {
+            return m_DroppedEvents.load(std::memory_order_relaxed);
+        }
+
+        // Copies an event only known by its base class, e.g. coming from a Window callback
+        void sendEvent(const Event& event);
+
+        // Delivers everything queued so far, events sent by listeners are delivered by the next call
         void process();
+
     private:
-        eventpp::EventQueue<EventType, void(const EventPointer&), EventPolicy> m_Queue;
+        struct Delegate {
+            void* Instance;
+            void (*Invoke)(void*, Event&);
+        };
+
+        template<typename EventT>
+        void addDelegate(Delegate delegate) {
+            // Listeners for every event run after the ones registered for the concrete type
+            if constexpr (std::is_same_v<std::remove_const_t<EventT>, Event>) {
+                m_GlobalListeners.push_back(delegate);
+            }
+            else {
+                using Concrete = std::remove_const_t<EventT>;
+                if (!isRegistered(Concrete::getStaticType())) {
+                    registerEventType<Concrete>();
+                }
+
+                const auto index = static_cast<size_t>(Concrete::getStaticType());
+                if (index >= m_Listeners.size()) {
+                    m_Listeners.resize(index + 1);
+                }
+                m_Listeners[index].push_back(delegate);
+            }
+        }
+
+        struct EventTypeInfo {
+            size_t Size{ 0 };
+            size_t Alignment{ 0 };
+            Event* (*Copy)(void*, const Event&){ nullptr };
+            void (*Destroy)(Event&){ nullptr };
+            bool (*Coalesce)(Event&, const Event&){ nullptr };
+            bool CoalesceEnabled{ false };
+            bool Recordable{ false };
+            bool RecordEnabled{ false };
+            EventPriority Priority{ EventPriority::Normal };
+        };
+
+        struct QueuedEvent {
+            Event* Data;
+            uint64_t Sequence;
+        };
+
+        struct Queue {
+            FrameArena Arena;
+            std::vector<QueuedEvent> Events;
+        };
+
+        struct PostedEvent {
+            alignas(std::max_align_t) std::byte Storage[s_MaxPostedEventSize];
+            // Monotonic per thread, the merge interleaves producers by it
+            uint64_t Timestamp;
+            EventType Type;
+            void (EventDispatcher::*Register)();
+            Event* (*Relocate)(void*, void*);
+            void (*Destroy)(void*);
+            size_t Size;
+            size_t Alignment;
+        };
+
+        // Single producer ring written by one posting thread and drained by the main thread. Shared with the posting thread,
+        // which marks it retired when it exits so the dispatcher can drop it once drained.
+        struct ProducerQueue {
+            std::atomic<bool> Retired{ false };
+            alignas(64) std::atomic<uint32_t> Head{ 0 };
+            alignas(64) std::atomic<uint32_t> Tail{ 0 };
+            PostedEvent Slots[s_PostedQueueCapacity];
+        };
+
+        // Taken from a clock rather than a shared counter so posting threads do not contend
+        static uint64_t getPostTimestamp() {
+            return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        }
+
+        // Part of a producer queue taken by one merge
+        struct PostedRange {
+            ProducerQueue* Producer;
+            uint32_t Head;
+            uint32_t Tail;
+            bool Retired;
+        };
+
+        uint64_t nextSequence() {
+            return m_NextSequence++;
+        }
+
+        ProducerQueue& getProducerQueue();
+        void mergePostedEvents();
+
+        [[nodiscard]] bool isRegistered(EventType type) const {
+            const auto index = static_cast<size_t>(type);
+            return index < m_EventTypes.size() && m_EventTypes[index].Copy;
+        }
+
+        void clear(Queue& queue);
+        void defer(Queue& queue, size_t first);
+
+        // Returns true when the event was merged into a queued one and must not be queued itself
+        bool tryCoalesce(const Event& event);
+        // Fills in the delta of a MouseMovedEvent from the previous position
+        void trackMouseMove(Event& event);
+        void breakCoalescing();
+
+        std::vector<EventTypeInfo> m_EventTypes;
+        std::vector<std::vector<Delegate>> m_Listeners;
+        std::vector<Delegate> m_GlobalListeners;
+
+        Queue m_Queues[2];
+        uint32_t m_WriteQueue{ 0 };
+
+        static constexpr size_t s_NoPendingEvent{ SIZE_MAX };
+        // Per type, index of the queued event the next one of that type may merge into
+        std::vector<size_t> m_PendingCoalesce;
+        bool m_HasPendingCoalesce{ false };
+        uint64_t m_CoalescedEvents{ 0 };
+
+        float m_MouseX{ 0.0f };
+        float m_MouseY{ 0.0f };
+        bool m_HasMousePosition{ false };
+
+        EventRecorder* m_Recorder{ nullptr };
+
+        uint32_t m_ProcessingBudget{ 0 };
+        uint64_t m_DeferredEvents{ 0 };
+
+        // Main thread only, posted events are numbered when they are merged
+        uint64_t m_NextSequence{ 0 };
+
+        const uint64_t m_Id;
+        std::atomic<uint64_t> m_DroppedEvents{ 0 };
+        std::mutex m_ProducersMutex;
+        std::vector<Ref<ProducerQueue>> m_Producers;
+        // Reused by every merge, main thread only
+        std::vector<PostedRange> m_PostedRanges;
     };
 }
@@ -0,0 +1,153 @@
+#include "vipch.hpp"
+#include "Vi/Event/EventRecorder.hpp"
+
+#include "Vi/Core/FileSystem.hpp"
+#include "Vi/Event/EventDispatcher.hpp"
+
+namespace Vi {
+	namespace {
+		constexpr char s_Magic[4]{ 'V', 'I', 'E', 'V' };
+		constexpr uint32_t s_Version{ 1 };
+
+		struct EventLogHeader {
+			char Magic[4];
+			uint32_t Version;
+		};
+
+		// Records are packed without padding, the payload directly follows the fields
+		constexpr size_t s_RecordSize{ sizeof(uint64_t) + sizeof(uint64_t) + sizeof(EventType) + sizeof(uint16_t) };
+
+		template<typename T>
+		std::byte* writeField(std::byte* destination, const T& value) {
+			std::memcpy(destination, &value, sizeof(T));
+			return destination + sizeof(T);
+		}
+
+		template<typename T>
+		const uint8_t* readField(const uint8_t* source, T& value) {
+			std::memcpy(&value, source, sizeof(T));
+			return source + sizeof(T);
+		}
+	}
+
+	EventRecorder::~EventRecorder() {
+		close();
+	}
+
+	bool EventRecorder::open(const std::filesystem::path& filepath) {
+		close();
+
+		m_Stream.open(filepath, std::ios::binary | std::ios::trunc);
+		if (!m_Stream) {
+			VI_CORE_ERROR("Could not open event log {0} for writing", filepath.string());
+			return false;
+		}
+
+		EventLogHeader header{};
+		std::memcpy(header.Magic, s_Magic, sizeof(s_Magic));
+		header.Version = s_Version;
+		m_Stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		m_FrameIndex = 0;
+		m_RecordedEvents = 0;
+		m_Timer.reset();
+		return true;
+	}
+
+	void EventRecorder::close() {
+		if (!m_Stream.is_open()) {
+			return;
+		}
+
+		flush();
+		m_Stream.close();
+		VI_CORE_INFO("Recorded {0} events", m_RecordedEvents);
+	}
+
+	void EventRecorder::beginFrame(uint64_t frameIndex) {
+		flush();
+		m_FrameIndex = frameIndex;
+	}
+
+	void EventRecorder::record(const Event& event, size_t size) {
+		if (!m_Stream.is_open()) {
+			return;
+		}
+
+		const auto timestamp = static_cast<uint64_t>(m_Timer.elapsedSeconds() * 1e9);
+		const size_t offset = m_Buffer.size();
+		m_Buffer.resize(offset + s_RecordSize + size);
+
+		auto* destination = m_Buffer.data() + offset;
+		destination = writeField(destination, m_FrameIndex);
+		destination = writeField(destination, timestamp);
+		destination = writeField(destination, event.getType());
+		destination = writeField(destination, static_cast<uint16_t>(size));
+		std::memcpy(destination, &event, size);
+
+		m_RecordedEvents++;
+	}
+
+	void EventRecorder::flush() {
+		if (m_Buffer.empty()) {
+			return;
+		}
+
+		// One write per frame, records are collected in between
+		m_Stream.write(reinterpret_cast<const char*>(m_Buffer.data()), static_cast<std::streamsize>(m_Buffer.size()));
+		m_Buffer.clear();
+	}
+
+	EventReplayer::~EventReplayer() {
+		m_Data.release();
+	}
+
+	bool EventReplayer::open(const std::filesystem::path& filepath) {
+		m_Data.release();
+		m_Offset = 0;
+		m_ReplayedEvents = 0;
+
+		m_Data = FileSystem::readFileBinary(filepath);
+		EventLogHeader header{};
+		if (m_Data.Size < sizeof(header)) {
+			VI_CORE_ERROR("Could not read event log {0}", filepath.string());
+			m_Data.release();
+			return false;
+		}
+
+		std::memcpy(&header, m_Data.Data, sizeof(header));
+		if (std::memcmp(header.Magic, s_Magic, sizeof(s_Magic)) != 0 || header.Version != s_Version) {
+			VI_CORE_ERROR("{0} is not an event log of this version", filepath.string());
+			m_Data.release();
+			return false;
+		}
+
+		m_Offset = sizeof(header);
+		return true;
+	}
+
+	void EventReplayer::replayFrame(uint64_t frameIndex, EventDispatcher& dispatcher) {
+		while (m_Offset + s_RecordSize <= m_Data.Size) {
+			EventRecord record{};
+			const auto* source = m_Data.Data + m_Offset;
+			source = readField(source, record.FrameIndex);
+			if (record.FrameIndex > frameIndex) {
+				break;
+			}
+
+			source = readField(source, record.Timestamp);
+			source = readField(source, record.Type);
+			source = readField(source, record.Size);
+
+			if (m_Offset + s_RecordSize + record.Size > m_Data.Size) {
+				VI_CORE_ERROR("Event log is truncated, stopping the replay");
+				m_Offset = m_Data.Size;
+				break;
+			}
+
+			dispatcher.sendRecordedEvent(record.Type, source, record.Size);
+			m_Offset += s_RecordSize + record.Size;
+			m_ReplayedEvents++;
+		}
+	}
+}
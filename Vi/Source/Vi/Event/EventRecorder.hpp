@@ -0,0 +1,84 @@
+#pragma once
+#include "Vi/Core/Buffer.hpp"
+#include "Vi/Core/Timer.hpp"
+#include "Vi/Event/Event.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace Vi {
+    class EventDispatcher;
+
+    // Binary event log: a header followed by one record per event, each record being the frame index, the
+    // nanoseconds since recording started, the event type and size and then the raw bytes of the event.
+    // Events are stored as memory images, a log is only meant to be replayed by a build of the same engine.
+    struct EventRecord {
+        uint64_t FrameIndex;
+        uint64_t Timestamp;
+        EventType Type;
+        uint16_t Size;
+    };
+
+    class EventRecorder {
+    public:
+        EventRecorder() = default;
+        ~EventRecorder();
+
+        EventRecorder(const EventRecorder&) = delete;
+        EventRecorder& operator=(const EventRecorder&) = delete;
+
+        bool open(const std::filesystem::path& filepath);
+        void close();
+
+        [[nodiscard]] bool isOpen() const {
+            return m_Stream.is_open();
+        }
+
+        // Writes out the previous frame and stamps everything recorded from now on with this index
+        void beginFrame(uint64_t frameIndex);
+        void record(const Event& event, size_t size);
+
+        [[nodiscard]] uint64_t getRecordedEventCount() const {
+            return m_RecordedEvents;
+        }
+
+    private:
+        void flush();
+
+        std::ofstream m_Stream;
+        std::vector<std::byte> m_Buffer;
+        uint64_t m_FrameIndex{ 0 };
+        uint64_t m_RecordedEvents{ 0 };
+        Timer m_Timer;
+    };
+
+    // Feeds a recorded log back into a dispatcher, frame by frame
+    class EventReplayer {
+    public:
+        EventReplayer() = default;
+        ~EventReplayer();
+
+        EventReplayer(const EventReplayer&) = delete;
+        EventReplayer& operator=(const EventReplayer&) = delete;
+
+        bool open(const std::filesystem::path& filepath);
+
+        // Sends every event recorded up to and including this frame
+        void replayFrame(uint64_t frameIndex, EventDispatcher& dispatcher);
+
+        [[nodiscard]] bool isFinished() const {
+            return m_Offset >= m_Data.Size;
+        }
+
+        [[nodiscard]] uint64_t getReplayedEventCount() const {
+            return m_ReplayedEvents;
+        }
+
+    private:
+        Buffer m_Data;
+        uint64_t m_Offset{ 0 };
+        uint64_t m_ReplayedEvents{ 0 };
+    };
+}
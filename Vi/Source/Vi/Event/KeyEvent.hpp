@@ -0,0 +1,64 @@
+#pragma once
+#include "Vi/Event/Event.hpp"
+#include "Vi/Core/KeyCodes.hpp"
+
+namespace Vi {
+    class KeyEvent: public Event {
+    public:
+        KeyCode getKeyCode() const {
+            return m_KeyCode;
+        }
+
+    protected:
+        KeyEvent(const EventType type, const KeyCode keycode) : Event(type), m_KeyCode(keycode) {
+
+        }
+
+        KeyCode m_KeyCode;
+    };
+
+    class KeyPressedEvent: public KeyEvent {
+    public:
+        KeyPressedEvent(const KeyCode keycode, bool isRepeat = false) : KeyEvent(getStaticType(), keycode), m_IsRepeat(isRepeat) {
+
+        }
+
+        static EventType getStaticType() {
+            return EventType::KeyPressed;
+        }
+
+        // Only auto-repeats of the same key merge, the first press of a key is always delivered
+        static bool coalesce(KeyPressedEvent& pending, const KeyPressedEvent& incoming) {
+            return pending.m_IsRepeat && incoming.m_IsRepeat && pending.m_KeyCode == incoming.m_KeyCode;
+        }
+
+        bool isRepeat() const {
+            return m_IsRepeat;
+        }
+
+    private:
+        bool m_IsRepeat;
+    };
+
+    class KeyReleasedEvent: public KeyEvent {
+    public:
+        KeyReleasedEvent(const KeyCode keycode) : KeyEvent(getStaticType(), keycode) {
+
+        }
+
+        static EventType getStaticType() {
+            return EventType::KeyReleased;
+        }
+    };
+
+    class KeyTypedEvent: public KeyEvent {
+    public:
+        KeyTypedEvent(const KeyCode keycode) : KeyEvent(getStaticType(), keycode) {
+
+        }
+
+        static EventType getStaticType() {
+            return EventType::KeyTyped;
+        }
+    };
+}
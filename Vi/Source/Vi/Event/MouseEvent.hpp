@@ -0,0 +1,117 @@
+#pragma once
+#include "Vi/Event/Event.hpp"
+#include "Vi/Core/MouseCodes.hpp"
+
+namespace Vi {
+    class EventDispatcher;
+
+    class MouseMovedEvent: public Event {
+    public:
+        MouseMovedEvent(const float x, const float y) : Event(getStaticType()), m_MouseX(x), m_MouseY(y) {
+
+        }
+
+        static EventType getStaticType() {
+            return EventType::MouseMoved;
+        }
+
+        // Coalesced moves end at the newest position and cover the whole distance travelled
+        static bool coalesce(MouseMovedEvent& pending, const MouseMovedEvent& incoming) {
+            pending.m_MouseX = incoming.m_MouseX;
+            pending.m_MouseY = incoming.m_MouseY;
+            pending.m_DeltaX += incoming.m_DeltaX;
+            pending.m_DeltaY += incoming.m_DeltaY;
+            return true;
+        }
+
+        float getX() const {
+            return m_MouseX;
+        }
+
+        float getY() const {
+            return m_MouseY;
+        }
+
+        // Movement since the previous MouseMovedEvent the dispatcher saw, 0 for the first one
+        float getDeltaX() const {
+            return m_DeltaX;
+        }
+
+        float getDeltaY() const {
+            return m_DeltaY;
+        }
+
+    private:
+        friend class EventDispatcher;
+
+        float m_MouseX;
+        float m_MouseY;
+        float m_DeltaX{ 0.0f };
+        float m_DeltaY{ 0.0f };
+    };
+
+    class MouseScrolledEvent: public Event {
+    public:
+        MouseScrolledEvent(const float xOffset, const float yOffset) : Event(getStaticType()), m_XOffset(xOffset), m_YOffset(yOffset) {
+
+        }
+
+        static EventType getStaticType() {
+            return EventType::MouseScrolled;
+        }
+
+        static bool coalesce(MouseScrolledEvent& pending, const MouseScrolledEvent& incoming) {
+            pending.m_XOffset += incoming.m_XOffset;
+            pending.m_YOffset += incoming.m_YOffset;
+            return true;
+        }
+
+        float getXOffset() const {
+            return m_XOffset;
+        }
+
+        float getYOffset() const {
+            return m_YOffset;
+        }
+
+    private:
+        float m_XOffset;
+        float m_YOffset;
+    };
+
+    class MouseButtonEvent: public Event {
+    public:
+        MouseCode getMouseButton() const {
+            return m_Button;
+        }
+
+    protected:
+        MouseButtonEvent(const EventType type, const MouseCode button) : Event(type), m_Button(button) {
+
+        }
+
+        MouseCode m_Button;
+    };
+
+    class MouseButtonPressedEvent: public MouseButtonEvent {
+    public:
+        MouseButtonPressedEvent(const MouseCode button) : MouseButtonEvent(getStaticType(), button) {
+
+        }
+
+        static EventType getStaticType() {
+            return EventType::MouseButtonPressed;
+        }
+    };
+
+    class MouseButtonReleasedEvent: public MouseButtonEvent {
+    public:
+        MouseButtonReleasedEvent(const MouseCode button) : MouseButtonEvent(getStaticType(), button) {
+
+        }
+
+        static EventType getStaticType() {
+            return EventType::MouseButtonReleased;
+        }
+    };
+}
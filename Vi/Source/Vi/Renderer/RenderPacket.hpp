@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Vi/Core/InplaceFunction.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace Vi {
+    // Snapshot of everything needed to render one frame. Built by layers on the main thread and executed by the render thread,
+    // so commands have to capture their data by value.
+    class RenderPacket {
+    public:
+        using Command = InplaceFunction<void(), 64>;
+
+        void reset(uint64_t frameIndex, float alpha) {
+            m_Commands.clear();
+            m_FrameIndex = frameIndex;
+            m_Alpha = alpha;
+        }
+
+        template<typename Function>
+        void submit(Function&& command) {
+            m_Commands.emplace_back(std::forward<Function>(command));
+        }
+
+        void execute() {
+            for (auto& command : m_Commands) {
+                command();
+            }
+        }
+
+        [[nodiscard]] uint64_t getFrameIndex() const {
+            return m_FrameIndex;
+        }
+
+        [[nodiscard]] float getAlpha() const {
+            return m_Alpha;
+        }
+
+    private:
+        std::vector<Command> m_Commands;
+        uint64_t m_FrameIndex{ 0 };
+        float m_Alpha{ 1.0f };
+    };
+}
@@ -27,6 +27,7 @@
 #include "Vi/Core/Log.hpp"
 
 #include "Vi/Debug/Instrumentor.hpp"
+#include "Vi/Debug/MemoryTracker.hpp"
 
 #ifdef VI_PLATFORM_WINDOWS
 #include <Windows.h>
@@ -53,10 +53,7 @@ project "Vi"
         "GLFW",
         "Glad",
         "ImGui",
-        "yaml-cpp",
-        "opengl32.lib",
-
-        "%{Library.mono}",
+        "yaml-cpp"
     }
 
     filter "files:vendor/ImGuizmo/**.cpp"
@@ -67,6 +64,8 @@ project "Vi"
 
         links
         {
+            "opengl32.lib",
+            "%{Library.mono}",
             "%{Library.WinSock}",
             "%{Library.WinMM}",
             "%{Library.WinVersion}",
@@ -78,6 +77,13 @@ project "Vi"
         runtime "Debug"
         symbols "on"
 
+    filter "configurations:Release"
+        defines "VI_RELEASE"
+        runtime "Release"
+        optimize "on"
+
+    -- The Vulkan SDK libraries are only set up for Windows, a headless Linux build does not need them
+    filter { "system:windows", "configurations:Debug" }
         links
         {
             "%{Library.ShaderC_Debug}",
@@ -85,11 +91,7 @@ project "Vi"
             "%{Library.SPIRV_Cross_GLSL_Debug}"
         }
 
-    filter "configurations:Release"
-        defines "VI_RELEASE"
-        runtime "Release"
-        optimize "on"
-
+    filter { "system:windows", "configurations:Release" }
         links
         {
             "%{Library.ShaderC_Release}",
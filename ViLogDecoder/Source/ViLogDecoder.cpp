@@ -0,0 +1,246 @@
+// Turns binary logs written with LogFileFormat::Binary back into the text the file sink would have written.
+// Usage: ViLogDecoder <log file> [output file]
+
+#include "Vi/Core/BinaryLogFormat.hpp"
+
+#include <spdlog/fmt/fmt.h>
+#ifdef SPDLOG_FMT_EXTERNAL
+#include <fmt/args.h>
+#else
+#include <spdlog/fmt/bundled/args.h>
+#endif
+
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    using namespace Vi::BinaryLogFormat;
+
+    constexpr const char* s_LevelNames[]{ "trace", "debug", "info", "warning", "error", "critical", "off" };
+
+    struct Format {
+        uint8_t Level;
+        std::string Logger;
+        std::string File;
+        uint32_t Line;
+        std::string Text;
+    };
+
+    // Reads values from a record and stops at its end instead of running past a truncated one
+    class Reader {
+    public:
+        Reader(const char* data, size_t size): m_Data(data), m_Size(size) {
+
+        }
+
+        template<typename T>
+        bool read(T& value) {
+            if (m_Offset + sizeof(T) > m_Size) {
+                return false;
+            }
+
+            std::memcpy(&value, m_Data + m_Offset, sizeof(T));
+            m_Offset += sizeof(T);
+            return true;
+        }
+
+        bool readString(std::string& value) {
+            uint32_t length{ 0 };
+            if (!read(length) || m_Offset + length > m_Size) {
+                return false;
+            }
+
+            value.assign(m_Data + m_Offset, length);
+            m_Offset += length;
+            return true;
+        }
+
+    private:
+        const char* m_Data;
+        size_t m_Size;
+        size_t m_Offset{ 0 };
+    };
+
+    bool readFormat(Reader& reader, std::unordered_map<uint32_t, Format>& formats) {
+        uint32_t id{ 0 };
+        Format format{};
+        if (!reader.read(id) || !reader.read(format.Level) || !reader.readString(format.Logger) || !reader.readString(format.File) || !reader.read(format.Line) || !reader.readString(format.Text)) {
+            return false;
+        }
+
+        formats[id] = std::move(format);
+        return true;
+    }
+
+    bool readArguments(Reader& reader, fmt::dynamic_format_arg_store<fmt::format_context>& arguments) {
+        uint8_t count{ 0 };
+        if (!reader.read(count)) {
+            return false;
+        }
+
+        for (uint8_t i = 0; i < count; i++) {
+            ArgumentTag tag{};
+            if (!reader.read(tag)) {
+                return false;
+            }
+
+            switch (tag) {
+            case ArgumentTag::Int: {
+                int64_t value{ 0 };
+                if (!reader.read(value)) return false;
+                arguments.push_back(value);
+                break;
+            }
+            case ArgumentTag::UInt: {
+                uint64_t value{ 0 };
+                if (!reader.read(value)) return false;
+                arguments.push_back(value);
+                break;
+            }
+            case ArgumentTag::Double: {
+                double value{ 0.0 };
+                if (!reader.read(value)) return false;
+                arguments.push_back(value);
+                break;
+            }
+            case ArgumentTag::Bool: {
+                uint8_t value{ 0 };
+                if (!reader.read(value)) return false;
+                arguments.push_back(value != 0);
+                break;
+            }
+            case ArgumentTag::Char: {
+                char value{ 0 };
+                if (!reader.read(value)) return false;
+                arguments.push_back(value);
+                break;
+            }
+            case ArgumentTag::String: {
+                std::string value;
+                if (!reader.readString(value)) return false;
+                arguments.push_back(std::move(value));
+                break;
+            }
+            case ArgumentTag::Pointer: {
+                uint64_t value{ 0 };
+                if (!reader.read(value)) return false;
+                arguments.push_back(reinterpret_cast<const void*>(static_cast<uintptr_t>(value)));
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::string formatTime(int64_t timestamp) {
+        const std::chrono::system_clock::time_point time{ std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(timestamp)) };
+        const std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+
+        std::tm local{};
+#ifdef _WIN32
+        localtime_s(&local, &seconds);
+#else
+        localtime_r(&seconds, &local);
+#endif
+
+        char buffer[16];
+        std::strftime(buffer, sizeof(buffer), "%H:%M:%S", &local);
+        return buffer;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: ViLogDecoder <log file> [output file]\n";
+        return 1;
+    }
+
+    std::ifstream input(argv[1], std::ios::binary);
+    if (!input) {
+        std::cerr << "Could not open " << argv[1] << "\n";
+        return 1;
+    }
+
+    std::ofstream file;
+    if (argc > 2) {
+        file.open(argv[2]);
+        if (!file) {
+            std::cerr << "Could not open " << argv[2] << " for writing\n";
+            return 1;
+        }
+    }
+    std::ostream& output = argc > 2 ? file : std::cout;
+
+    FileHeader fileHeader{};
+    input.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader));
+    if (!input || std::memcmp(fileHeader.Magic, s_Magic, sizeof(s_Magic)) != 0) {
+        std::cerr << argv[1] << " is not a Vi binary log\n";
+        return 1;
+    }
+
+    if (fileHeader.Version != s_Version) {
+        std::cerr << argv[1] << " has version " << fileHeader.Version << ", this decoder reads version " << s_Version << "\n";
+        return 1;
+    }
+
+    std::unordered_map<uint32_t, Format> formats;
+    std::vector<char> payload;
+    RecordHeader header{};
+    uint64_t records{ 0 };
+
+    while (input.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        payload.resize(header.Size);
+        if (!input.read(payload.data(), header.Size)) {
+            std::cerr << "Log ends in a truncated record after " << records << " records\n";
+            break;
+        }
+        records++;
+
+        Reader reader(payload.data(), payload.size());
+        RecordKind kind{};
+        reader.read(kind);
+
+        if (kind == RecordKind::Format) {
+            if (!readFormat(reader, formats)) {
+                std::cerr << "Malformed format record " << records << "\n";
+            }
+            continue;
+        }
+
+        uint32_t id{ 0 };
+        fmt::dynamic_format_arg_store<fmt::format_context> arguments;
+        if (kind != RecordKind::Message || !reader.read(id) || !readArguments(reader, arguments)) {
+            std::cerr << "Malformed record " << records << "\n";
+            continue;
+        }
+
+        const auto format = formats.find(id);
+        if (format == formats.end()) {
+            std::cerr << "Record " << records << " uses unknown format " << id << "\n";
+            continue;
+        }
+
+        const auto& [level, logger, sourceFile, line, text] = format->second;
+        std::string message;
+        try {
+            message = fmt::vformat(text, arguments);
+        }
+        catch (const fmt::format_error& error) {
+            message = fmt::format("{} (could not format: {})", text, error.what());
+        }
+
+        output << fmt::format("[{}] [{}] {}: {}\n", formatTime(header.Timestamp), s_LevelNames[level < 7 ? level : 6], logger, message);
+    }
+
+    return 0;
+}
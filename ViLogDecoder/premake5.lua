@@ -0,0 +1,33 @@
+project "ViLogDecoder"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++20"
+    staticruntime "off"
+
+    targetdir ("%{wks.location}/bin/" .. outputdir .. "/%{prj.name}")
+    objdir ("%{wks.location}/bin/int/" .. outputdir .. "/%{prj.name}")
+
+    files
+    {
+        "Source/**.hpp",
+        "Source/**.cpp"
+    }
+
+    includedirs
+    {
+        "%{wks.location}/Vi/Source",
+        "%{IncludeDir.spdlog}"
+    }
+
+    filter "system:windows"
+        systemversion "latest"
+
+    filter "configurations:Debug"
+        defines "VI_DEBUG"
+        runtime "Debug"
+        symbols "on"
+
+    filter "configurations:Release"
+        defines "VI_RELEASE"
+        runtime "Release"
+        optimize "on"
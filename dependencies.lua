@@ -4,6 +4,7 @@
 VULKAN_SDK = os.getenv("VULKAN_SDK")
 
 IncludeDir = {}
+IncludeDir["spdlog"] = "%{wks.location}/Vi/vendor/spdlog/include"
 IncludeDir["stb_image"] = "%{wks.location}/Vi/vendor/stb_image"
 IncludeDir["yaml_cpp"] = "%{wks.location}/Vi/vendor/yaml-cpp/include"
 IncludeDir["Box2D"] = "%{wks.location}/Vi/vendor/Box2D/include"
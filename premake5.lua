@@ -1,6 +1,12 @@
 include "./vendor/premake/premake_customization/solution_items.lua"
 include "dependencies.lua"
 
+newoption
+{
+    trigger = "track-memory",
+    description = "Account every heap allocation to the subsystem that made it"
+}
+
 workspace "ViEngine"
     architecture "x86_64"
     startproject "Viking"
@@ -21,6 +27,12 @@ workspace "ViEngine"
         "MultiProcessorCompile"
     }
 
+    -- Changes the layout of every heap allocation, so Vi and everything linking it must agree on it
+    defines
+    {
+        "VI_TRACK_MEMORY=" .. (_OPTIONS["track-memory"] and "1" or "0")
+    }
+
     outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
 
     group "Dependencies"
@@ -39,6 +51,7 @@ workspace "ViEngine"
 
     group "Tools"
         -- include "ViEd"
+        include "ViLogDecoder"
     group ""
 
     group "Misc"